@@ -0,0 +1,107 @@
+
+// note  : helpers of benchmarks: clock, key sequence, result line and cache miss counter.
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+	// steady clock: seconds.
+	inline double now() {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// splitmix64, same sequence for every run.
+	inline unsigned long long next_key(unsigned long long &state) {
+		unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	// sizes from command line, or the default ones.
+	inline std::vector<unsigned long long> sizes(int argc, char **argv, std::vector<unsigned long long> def) {
+		if (argc <= 1) return def;
+		std::vector<unsigned long long> r;
+		for (int i = 1; i < argc; i++) {
+			r.push_back(strtoull(argv[i], nullptr, 10));
+		}
+		return r;
+	}
+
+	// result line: million operations per second.
+	inline void report(const char *name, unsigned long long n, const char *op, unsigned long long ops, double sec) {
+		printf("%-24s n=%-10llu %-10s %8.2f Mops/s\n", name, n, op, sec > 0 ? ops / sec / 1e6 : 0.0);
+	}
+
+	// hardware cache miss counter of current thread(linux perf event),
+	// it is not valid when perf events are not allowed(as in most containers).
+	class CMissCounter final {
+	public:
+		// l1: L1 data read misses, or last level cache misses.
+		explicit CMissCounter(bool l1) : m_fd(-1) {
+#if defined(__linux__)
+			struct perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			if (l1) {
+				attr.type = PERF_TYPE_HW_CACHE;
+				attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+					(PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+			} else {
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_CACHE_MISSES;
+			}
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			m_fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+			(void)l1;
+#endif
+		}
+		~CMissCounter() {
+#if defined(__linux__)
+			if (m_fd >= 0) close(m_fd);
+#endif
+		}
+		// can not copyable class.
+		const CMissCounter& operator=(const CMissCounter& rhs) = delete;
+		CMissCounter(const CMissCounter& rhs) = delete;
+
+	public:
+		bool valid() const { return m_fd >= 0; }
+
+		void start() {
+#if defined(__linux__)
+			if (m_fd < 0) return;
+			ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+		}
+
+		// misses from start.
+		unsigned long long stop() {
+			unsigned long long count = 0;
+#if defined(__linux__)
+			if (m_fd < 0) return 0;
+			ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+			if (read(m_fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+			return count;
+		}
+
+	private:
+		int m_fd;
+	};
+}
@@ -0,0 +1,73 @@
+
+// note  : bulk add and kill of register against adding and killing timers one by one.
+// usage : bench_bulk [size ...], default 1000 100000 1000000.
+
+#include "bench.h"
+#include "time_wheel.h"
+
+using namespace STimeWheelSpace;
+
+static void run_bulk(unsigned long long n) {
+	std::vector<int32> delays(n);
+	std::vector<uint64> ids(n);
+	unsigned long long state = n;
+	for (unsigned long long i = 0; i < n; i++) {
+		delays[i] = int32(1 + bench::next_key(state) % (60 * 60 * 1000));
+		ids[i] = i + 1;
+	}
+
+	// one by one.
+	double single_add, single_kill;
+	{
+		CTimeWheel wheel;
+		CTimerRegister reg(wheel);
+		double t0 = bench::now();
+		for (unsigned long long i = 0; i < n; i++) {
+			reg.add_once_timer([](void*) {}, ids[i], delays[i]);
+		}
+		double t1 = bench::now();
+		for (unsigned long long i = 0; i < n; i++) {
+			reg.kill_timer(ids[i]);
+		}
+		double t2 = bench::now();
+		single_add = t1 - t0;
+		single_kill = t2 - t1;
+	}
+
+	// bulk, specs are made before timing.
+	double bulk_add, bulk_kill;
+	{
+		CTimeWheel wheel;
+		CTimerRegister reg(wheel);
+		std::vector<timer_spec> specs(n);
+		for (unsigned long long i = 0; i < n; i++) {
+			specs[i].func = [](void*) {};
+			specs[i].id = ids[i];
+			specs[i].delay = delays[i];
+			specs[i].timerType = onceType;
+		}
+		double t0 = bench::now();
+		uint32 added = reg.add_timers(specs.data(), uint32(n));
+		double t1 = bench::now();
+		uint32 killed = reg.kill_timers(ids.data(), uint32(n));
+		double t2 = bench::now();
+		if (added != n || killed != n) {
+			printf("bulk: added %u killed %u of %llu\n", added, killed, n);
+			exit(1);
+		}
+		bulk_add = t1 - t0;
+		bulk_kill = t2 - t1;
+	}
+
+	bench::report("register one by one", n, "add", n, single_add);
+	bench::report("register bulk", n, "add", n, bulk_add);
+	bench::report("register one by one", n, "kill", n, single_kill);
+	bench::report("register bulk", n, "kill", n, bulk_kill);
+}
+
+int main(int argc, char **argv) {
+	for (unsigned long long n : bench::sizes(argc, argv, { 1000, 100000, 1000000 })) {
+		run_bulk(n);
+	}
+	return 0;
+}
@@ -0,0 +1,61 @@
+
+// note  : fire lateness of busy-poll run against the sleep loop(run, sleep 1 tick),
+//         lateness is the time from the tick time of a fired timer to its callback.
+// usage : bench_busy_poll [seconds], default 3 for every mode.
+
+#include <algorithm>
+#include <thread>
+#include "bench.h"
+#include "time_wheel.h"
+
+using namespace STimeWheelSpace;
+
+static int64 now_us() {
+	return int64(bench::now() * 1e6);
+}
+
+static void run_mode(bool spin, unsigned long long seconds) {
+	CTimeWheel wheel;
+	const int64 tick_us = wheel.get_geometry().tick_us;
+	// tick t is handled at base + (t + 1) * tick.
+	int64 base = wheel.get_tick_time(0) - tick_us;
+	std::vector<int64> late;
+	late.reserve(seconds * 100000);
+	for (int32 i = 1; i <= 20; i++) {
+		wheel.add_repeated_timer([&](void*) {
+			late.push_back(now_us() - (base + int64(wheel.get_tick() + 1) * tick_us));
+		}, i);
+	}
+
+	if (spin) {
+		std::thread stopper([&wheel, seconds]() {
+			std::this_thread::sleep_for(std::chrono::seconds(seconds));
+			wheel.stop_run();
+		});
+		wheel.run_busy_poll();
+		stopper.join();
+	} else {
+		double end = bench::now() + double(seconds);
+		while (bench::now() < end) {
+			wheel.run();
+			std::this_thread::sleep_for(std::chrono::microseconds(tick_us));
+		}
+	}
+
+	std::sort(late.begin(), late.end());
+	size_t n = late.size();
+	if (n == 0) {
+		printf("busy poll: nothing fired\n");
+		exit(1);
+	}
+	printf("%-24s fired %-8zu late p50 %lldus p99 %lldus p99.9 %lldus max %lldus\n",
+		spin ? "busy-poll" : "sleep loop", n, (long long)late[n / 2], (long long)late[n * 99 / 100],
+		(long long)late[n * 999 / 1000], (long long)late[n - 1]);
+}
+
+int main(int argc, char **argv) {
+	unsigned long long seconds = argc > 1 ? strtoull(argv[1], nullptr, 10) : 3;
+	run_mode(false, seconds);
+	run_mode(true, seconds);
+	return 0;
+}
@@ -0,0 +1,67 @@
+
+// note  : arm/disarm pairs of deadlines which are always disarmed in time:
+//         CDeadline against add_once_timer plus kill_timer, and register add plus kill.
+// usage : bench_deadline [pairs ...], default 5000000.
+
+#include <new>
+#include "bench.h"
+#include "timer_deadline.h"
+
+using namespace STimeWheelSpace;
+
+// heap allocation count, arm/disarm of a warm wheel must not allocate.
+static unsigned long long allocs = 0;
+
+void* operator new(size_t size) {
+	allocs++;
+	void *p = malloc(size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static void run_deadline(unsigned long long n) {
+	CTimeWheel wheel;
+	CTimerRegister reg(wheel);
+	wheel.reserve_timer(1024);
+	uint32 fired = 0;
+
+	// deadlines of 3s, wheel moves a tick every 1024 pairs.
+	unsigned long long allocs0 = allocs;
+	double t0 = bench::now();
+	for (unsigned long long i = 0; i < n; i++) {
+		CDeadline deadline([&fired](void*) { fired++; }, int32(3000 + (i & 1023)), wheel);
+		if ((i & 1023) == 0) wheel.update(1);
+	}
+	double t1 = bench::now();
+	unsigned long long deadline_allocs = allocs - allocs0;
+	for (unsigned long long i = 0; i < n; i++) {
+		timer_handle handle = wheel.add_once_timer([&fired](void*) { fired++; }, int32(3000 + (i & 1023)));
+		wheel.kill_timer(handle);
+		if ((i & 1023) == 0) wheel.update(1);
+	}
+	double t2 = bench::now();
+	for (unsigned long long i = 0; i < n; i++) {
+		reg.add_once_timer([&fired](void*) { fired++; }, 1, int32(3000 + (i & 1023)));
+		reg.kill_timer(1);
+		if ((i & 1023) == 0) wheel.update(1);
+	}
+	double t3 = bench::now();
+
+	if (fired != 0 || wheel.get_all_timer() != 0) {
+		printf("deadline: fired %u timers %u\n", fired, wheel.get_all_timer());
+		exit(1);
+	}
+	bench::report("CDeadline", n, "pairs", n, t1 - t0);
+	printf("%-24s n=%-10llu %-10s %8llu\n", "CDeadline", n, "allocs", deadline_allocs);
+	bench::report("add_once+kill_timer", n, "pairs", n, t2 - t1);
+	bench::report("register add+kill", n, "pairs", n, t3 - t2);
+}
+
+int main(int argc, char **argv) {
+	for (unsigned long long n : bench::sizes(argc, argv, { 5000000 })) {
+		run_deadline(n);
+	}
+	return 0;
+}
@@ -0,0 +1,55 @@
+
+// note  : executor scaling: a burst of timers expires at once, every callback does a little
+//         work, time from the first callback to the last one is measured for shard counts.
+// usage : bench_executor [shards ...], default 1 2 4 8.
+
+#include <atomic>
+#include <thread>
+#include "bench.h"
+#include "timer_executor.h"
+
+using namespace STimeWheelSpace;
+
+static const uint32 burst = 200000;
+
+// about a microsecond of work.
+static uint64 work(uint64 seed) {
+	for (int i = 0; i < 200; i++) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+	}
+	return seed;
+}
+
+static void run_executor(uint32 shards) {
+	CTimerExecutor executor(shards, default_geometry, 1 << 16);
+	std::atomic<uint32> executed(0);
+	std::atomic<uint64> sink(0);
+	std::atomic<double> first(0);
+	executor.start();
+
+	for (uint32 i = 0; i < burst; i++) {
+		while (!executor.add_once_timer(i, [&, i](void*) {
+			double expected = 0;
+			first.compare_exchange_strong(expected, bench::now());
+			sink.fetch_add(work(i), std::memory_order_relaxed);
+			executed.fetch_add(1, std::memory_order_release);
+		}, 500)) {
+			std::this_thread::yield();
+		}
+	}
+	while (executed.load(std::memory_order_acquire) < burst) {
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+	double last = bench::now();
+	executor.stop();
+
+	bench::report("executor burst", shards, "callbacks", burst, last - first.load());
+	printf("%-24s n=%-10u %-10s %8llu\n", "executor burst", shards, "stolen", (unsigned long long)executor.get_stolen());
+}
+
+int main(int argc, char **argv) {
+	for (unsigned long long shards : bench::sizes(argc, argv, { 1, 2, 4, 8 })) {
+		run_executor(uint32(shards));
+	}
+	return 0;
+}
@@ -0,0 +1,94 @@
+
+// note  : fire path of wheel: time and cache misses(L1 data and last level) per fired timer,
+//         timers are spread over 1 ~ 1000ms and fired by one update, for every geometry:
+//         100us, 1ms and 10ms tick, as level 0 gets more slots there are fewer cascades.
+// usage : bench_fire [size ...] [tick_us:slots,slots,...], default 1000000 and the geometries
+//         below(15000000 needs about 3GB), as bench_fire 1000000 250:4000,60,60,60.
+
+#include "bench.h"
+#include "time_wheel.h"
+
+using namespace STimeWheelSpace;
+
+// geometry of result line.
+typedef struct fire_geometry {
+	char           name[32];
+	wheel_geometry geo;
+} fire_geometry;
+
+// default geometries: tick and level 0 slots.
+static std::vector<fire_geometry> default_geometries() {
+	return {
+		{ "100us 256x64x64x64", { 100, 4, { 256, 64, 64, 64 }, pool_start_size, pool_grow_size } },
+		{ "100us 10000x60x60x60", { 100, 4, { 10000, 60, 60, 60 }, pool_start_size, pool_grow_size } },
+		{ "1ms 64x64x64x64", { 1000, 4, { 64, 64, 64, 64 }, pool_start_size, pool_grow_size } },
+		{ "1ms 1000x60x60x24", default_geometry },
+		{ "10ms 100x60x60x24", { 10000, 4, { 100, 60, 60, 24 }, pool_start_size, pool_grow_size } },
+	};
+}
+
+// geometry from "tick_us:slots,slots,...", false if it is not a geometry.
+static bool parse_geometry(const char *arg, fire_geometry &out) {
+	const char *colon = strchr(arg, ':');
+	if (!colon) return false;
+
+	out.geo = default_geometry;
+	out.geo.tick_us = uint32(strtoul(arg, nullptr, 10));
+	out.geo.levels = 0;
+	const char *p = colon + 1;
+	while (*p && out.geo.levels < max_wheel_levels) {
+		char *end = nullptr;
+		out.geo.slots[out.geo.levels++] = uint32(strtoul(p, &end, 10));
+		p = (*end == ',') ? end + 1 : end;
+	}
+	snprintf(out.name, sizeof(out.name), "%s", arg);
+	return out.geo.tick_us > 0 && out.geo.levels > 0;
+}
+
+static void run_fire(const fire_geometry &g, unsigned long long n) {
+	CTimeWheel wheel(g.geo);
+	wheel.reserve_timer(uint32(n));
+	unsigned long long state = n;
+	unsigned long long fired = 0;
+	for (unsigned long long i = 0; i < n; i++) {
+		wheel.add_once_timer([&fired](void*) { fired++; }, int32(1 + bench::next_key(state) % 1000));
+	}
+
+	bench::CMissCounter l1(true), llc(false);
+	l1.start();
+	llc.start();
+	double t0 = bench::now();
+	wheel.update(uint32(wheel.to_ticks(1000) + 1));
+	double t1 = bench::now();
+	unsigned long long l1_miss = l1.stop();
+	unsigned long long llc_miss = llc.stop();
+	if (fired != n || wheel.get_all_timer() != 0) {
+		printf("fire: fired %llu of %llu\n", fired, n);
+		exit(1);
+	}
+
+	printf("fire %-24s n=%-10llu %6.1f ns/timer", g.name, n, (t1 - t0) * 1e9 / n);
+	if (l1.valid()) printf(", L1D miss %.2f/timer", double(l1_miss) / n);
+	else printf(", L1D miss n/a");
+	if (llc.valid()) printf(", LLC miss %.2f/timer\n", double(llc_miss) / n);
+	else printf(", LLC miss n/a\n");
+}
+
+int main(int argc, char **argv) {
+	std::vector<fire_geometry> geos;
+	std::vector<unsigned long long> sizes;
+	for (int i = 1; i < argc; i++) {
+		fire_geometry g;
+		if (parse_geometry(argv[i], g)) geos.push_back(g);
+		else sizes.push_back(strtoull(argv[i], nullptr, 10));
+	}
+	if (geos.empty()) geos = default_geometries();
+	if (sizes.empty()) sizes = { 1000000 };
+
+	for (const fire_geometry &g : geos) {
+		for (unsigned long long n : sizes) {
+			run_fire(g, n);
+		}
+	}
+	return 0;
+}
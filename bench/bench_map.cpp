@@ -0,0 +1,61 @@
+
+// note  : register timer map: flat robin hood map against std::map(the old map),
+//         add(insert), find and kill(erase) throughput of random uint64 keys.
+// usage : bench_map [size ...], default 1000 100000 10000000.
+
+#include <map>
+#include "bench.h"
+#include "flat_map.h"
+
+using namespace STimeWheelSpace;
+
+// small maps are filled and emptied again and again for a stable time.
+template <class Map>
+static void run_map(const char *name, const std::vector<unsigned long long> &keys, unsigned long long rounds) {
+	Map map;
+	unsigned long long n = keys.size();
+	void *value = &map;
+	double add = 0, find = 0, kill = 0;
+	unsigned long long found = 0;
+
+	for (unsigned long long r = 0; r < rounds; r++) {
+		double t0 = bench::now();
+		for (unsigned long long key : keys) {
+			map[key] = value;
+		}
+		double t1 = bench::now();
+		for (unsigned long long key : keys) {
+			found += (map.find(key) != map.end());
+		}
+		double t2 = bench::now();
+		for (unsigned long long key : keys) {
+			map.erase(key);
+		}
+		double t3 = bench::now();
+		add += t1 - t0;
+		find += t2 - t1;
+		kill += t3 - t2;
+	}
+
+	if (found != n * rounds) {
+		printf("%s: found %llu of %llu\n", name, found, n * rounds);
+		exit(1);
+	}
+	bench::report(name, n, "add", n * rounds, add);
+	bench::report(name, n, "find", n * rounds, find);
+	bench::report(name, n, "kill", n * rounds, kill);
+}
+
+int main(int argc, char **argv) {
+	for (unsigned long long n : bench::sizes(argc, argv, { 1000, 100000, 10000000 })) {
+		unsigned long long rounds = n < 1000000 ? 1000000 / n : 1;
+		std::vector<unsigned long long> keys(n);
+		unsigned long long state = n;
+		for (unsigned long long &key : keys) {
+			key = bench::next_key(state);
+		}
+		run_map<CFlatMap<void*>>("CFlatMap", keys, rounds);
+		run_map<std::map<unsigned long long, void*>>("std::map", keys, rounds);
+	}
+	return 0;
+}
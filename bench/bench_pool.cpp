@@ -0,0 +1,61 @@
+
+// note  : slab pool: adding timers with geometric growth against reserve() up front,
+//         and bytes held against bytes live after a spike is killed and trimmed.
+// usage : bench_pool [size ...], default 100000 1000000(15000000 needs about 3GB).
+
+#include "bench.h"
+#include "time_wheel.h"
+
+using namespace STimeWheelSpace;
+
+static double mb(size_t bytes) { return double(bytes) / (1024 * 1024); }
+
+static double add_all(CTimeWheel &wheel, const std::vector<int32> &delays, std::vector<timer_handle> &handles) {
+	double t0 = bench::now();
+	for (size_t i = 0; i < delays.size(); i++) {
+		handles[i] = wheel.add_once_timer([](void*) {}, delays[i]);
+	}
+	return bench::now() - t0;
+}
+
+static void run_pool(unsigned long long n) {
+	std::vector<int32> delays(n);
+	std::vector<timer_handle> handles(n);
+	unsigned long long state = n;
+	for (int32 &delay : delays) {
+		delay = int32(1 + bench::next_key(state) % (60 * 60 * 1000));
+	}
+
+	{
+		CTimeWheel wheel;
+		double add = add_all(wheel, delays, handles);
+		bench::report("pool grow", n, "add", n, add);
+	}
+
+	CTimeWheel wheel;
+	double t0 = bench::now();
+	wheel.reserve_timer(uint32(n));
+	double reserve = bench::now() - t0;
+	double add = add_all(wheel, delays, handles);
+	bench::report("pool reserved", n, "add", n, add);
+	printf("%-24s n=%-10llu %-10s %8.2f ms\n", "pool reserved", n, "reserve", reserve * 1000);
+
+	// spike is over: first 10% is the base load, the rest are killed.
+	for (unsigned long long i = n / 10; i < n; i++) {
+		wheel.kill_timer(handles[i]);
+	}
+	printf("%-24s n=%-10llu held %.1f MB, live %.1f MB\n", "after spike killed", n,
+		mb(wheel.get_pool_held()), mb(wheel.get_pool_live()));
+	t0 = bench::now();
+	uint32 released = wheel.trim_timer();
+	double trim = bench::now() - t0;
+	printf("%-24s n=%-10llu held %.1f MB, live %.1f MB, %u nodes released in %.2f ms\n", "after trim", n,
+		mb(wheel.get_pool_held()), mb(wheel.get_pool_live()), released, trim * 1000);
+}
+
+int main(int argc, char **argv) {
+	for (unsigned long long n : bench::sizes(argc, argv, { 100000, 1000000 })) {
+		run_pool(n);
+	}
+	return 0;
+}
@@ -0,0 +1,62 @@
+
+// note  : cross-thread post contention: producers post add and kill commands to one wheel,
+//         the wheel thread drains them with run_posted().
+// usage : bench_post [producers ...], default 1 2 4 8 16 32.
+
+#include <atomic>
+#include <thread>
+#include "bench.h"
+#include "time_wheel.h"
+
+using namespace STimeWheelSpace;
+
+static const unsigned long long total_pairs = 2000000;
+
+static void run_post(unsigned long long producers) {
+	CTimeWheel wheel(default_geometry, 4096);
+	unsigned long long pairs = total_pairs / producers;
+	std::atomic<unsigned long long> done(0);
+	std::atomic<bool> go(false);
+	std::vector<std::thread> threads;
+
+	for (unsigned long long p = 0; p < producers; p++) {
+		threads.emplace_back([&]() {
+			while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+			for (unsigned long long i = 0; i < pairs; i++) {
+				uint64 ticket;
+				while (!(ticket = wheel.post_once_timer([](void*) {}, 60 * 60 * 1000))) {
+					std::this_thread::yield();
+				}
+				while (!wheel.post_kill_timer(ticket)) {
+					std::this_thread::yield();
+				}
+			}
+			done.fetch_add(1, std::memory_order_release);
+		});
+	}
+
+	double t0 = bench::now();
+	go.store(true, std::memory_order_release);
+	unsigned long long commands = 0;
+	while (done.load(std::memory_order_acquire) < producers) {
+		uint32 count = wheel.run_posted();
+		commands += count;
+		if (count == 0) std::this_thread::yield();
+	}
+	commands += wheel.run_posted();
+	double t1 = bench::now();
+
+	for (std::thread &t : threads) t.join();
+	if (commands != 2 * pairs * producers || wheel.get_all_timer() != 0) {
+		printf("post: commands %llu timers %u\n", commands, wheel.get_all_timer());
+		exit(1);
+	}
+	bench::report("post add+kill", producers, "commands", commands, t1 - t0);
+}
+
+int main(int argc, char **argv) {
+	for (unsigned long long producers : bench::sizes(argc, argv, { 1, 2, 4, 8, 16, 32 })) {
+		run_post(producers);
+	}
+	return 0;
+}
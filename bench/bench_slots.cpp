@@ -0,0 +1,78 @@
+
+// note  : dense slots: add, kill and fire of many timers in few ticks,
+//         it is built as list slots(bench_slots) and array slots(bench_slots_soa).
+//         level 0 slot is taken whole, only a top level slot has timers of later laps
+//         and its due check is the compare over the array(avx2), so lap fire runs a
+//         single-level wheel of 64 slots with timers of 16 laps.
+// usage : bench_slots [size ...], default 100000 1000000.
+
+#include "bench.h"
+#include "time_wheel.h"
+
+using namespace STimeWheelSpace;
+
+#if TIME_WHEEL_SOA_SLOTS
+static const char *slot_mode = "array slots";
+#else
+static const char *slot_mode = "list slots";
+#endif
+
+static void run_slots(unsigned long long n) {
+	CTimeWheel wheel;
+	wheel.reserve_timer(uint32(n));
+	std::vector<timer_handle> handles(n);
+	unsigned long long state = n;
+	unsigned long long fired = 0;
+
+	// 64 ticks, so a slot has n / 64 timers.
+	double t0 = bench::now();
+	for (unsigned long long i = 0; i < n; i++) {
+		handles[i] = wheel.add_once_timer([&fired](void*) { fired++; }, int32(1 + bench::next_key(state) % 64));
+	}
+	double t1 = bench::now();
+	for (unsigned long long i = 0; i < n; i += 4) {
+		wheel.kill_timer(handles[i]);
+	}
+	double t2 = bench::now();
+	wheel.update(65);
+	double t3 = bench::now();
+
+	unsigned long long killed = (n + 3) / 4;
+	if (fired != n - killed || wheel.get_all_timer() != 0) {
+		printf("slots: fired %llu of %llu\n", fired, n - killed);
+		exit(1);
+	}
+	bench::report(slot_mode, n, "add", n, t1 - t0);
+	bench::report(slot_mode, n, "kill", killed, t2 - t1);
+	bench::report(slot_mode, n, "fire", n - killed, t3 - t2);
+}
+
+static void run_laps(unsigned long long n) {
+	const wheel_geometry geo = { 1000, 1, { 64 }, pool_start_size, pool_grow_size };
+	CTimeWheel wheel(geo);
+	wheel.reserve_timer(uint32(n));
+	unsigned long long state = n;
+	unsigned long long fired = 0;
+
+	// 16 laps of 64 ticks: a slot is visited 16 times and keeps later laps.
+	for (unsigned long long i = 0; i < n; i++) {
+		wheel.add_once_timer([&fired](void*) { fired++; }, int32(1 + bench::next_key(state) % 1024));
+	}
+	double t0 = bench::now();
+	wheel.update(1025);
+	double t1 = bench::now();
+
+	if (fired != n || wheel.get_all_timer() != 0) {
+		printf("slots: lap fired %llu of %llu\n", fired, n);
+		exit(1);
+	}
+	bench::report(slot_mode, n, "lap fire", n, t1 - t0);
+}
+
+int main(int argc, char **argv) {
+	for (unsigned long long n : bench::sizes(argc, argv, { 100000, 1000000 })) {
+		run_slots(n);
+		run_laps(n);
+	}
+	return 0;
+}
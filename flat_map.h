@@ -0,0 +1,196 @@
+
+// note  : flat open addressing hash map for uint64 key.
+// idea  : robin hood hashing with backward shift deletion, so there is no tombstone,
+//         and all entries are in one array(no allocation for every insertion).
+
+#pragma once
+
+#include <vector>
+#include <utility>
+
+namespace STimeWheelSpace {
+	// mix uint64 key bits(murmur3 finalizer), continuous keys are common.
+	inline unsigned long long mix_key(unsigned long long key) {
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		key *= 0xc4ceb9fe1a85ec53ULL;
+		key ^= key >> 33;
+		return key;
+	}
+
+	template <class V>
+	class CFlatMap final {
+	public:
+		typedef unsigned long long key_type;
+		typedef struct {
+			key_type first;              // key
+			V        second;             // value
+		} value_type;
+
+		// max load factor: 7/8.
+		static constexpr unsigned int load_num = 7;
+		static constexpr unsigned int load_den = 8;
+
+		// forward iterator over used entries.
+		class iterator {
+		public:
+			iterator(const CFlatMap *map, unsigned int pos) : m_map(map), m_pos(pos) { _skip(); }
+			value_type& operator*() const { return const_cast<value_type&>(m_map->m_slots[m_pos]); }
+			value_type* operator->() const { return &**this; }
+			iterator& operator++() { m_pos++; _skip(); return *this; }
+			iterator operator++(int) { iterator it = *this; ++*this; return it; }
+			bool operator==(const iterator &rhs) const { return m_pos == rhs.m_pos; }
+			bool operator!=(const iterator &rhs) const { return m_pos != rhs.m_pos; }
+			unsigned int pos() const { return m_pos; }
+
+		protected:
+			void _skip() {
+				unsigned int cap = (unsigned int)m_map->m_dist.size();
+				while (m_pos < cap && m_map->m_dist[m_pos] == 0) m_pos++;
+			}
+
+		private:
+			const CFlatMap *m_map;
+			unsigned int    m_pos;
+		};
+		typedef iterator const_iterator;
+
+	public:
+		CFlatMap() : m_size(0) {}
+		~CFlatMap() = default;
+
+	public:
+		iterator begin() const { return iterator(this, 0); }
+		iterator end() const { return iterator(this, capacity()); }
+
+		unsigned int size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+		unsigned int capacity() const { return (unsigned int)m_dist.size(); }
+
+		// find key, end() if there is none.
+		iterator find(key_type key) const {
+			if (m_size == 0) return end();
+
+			unsigned int mask = capacity() - 1;
+			unsigned int pos = _hash(key) & mask;
+			for (unsigned int dist = 1; m_dist[pos] >= dist; dist++) {
+				if (m_slots[pos].first == key) {
+					return iterator(this, pos);
+				}
+				pos = (pos + 1) & mask;
+			}
+			return end();
+		}
+
+		// value of key, insert default value if there is none.
+		V& operator[](key_type key) {
+			iterator it = find(key);
+			if (it != end()) return it->second;
+
+			if ((m_size + 1) * load_den > capacity() * load_num) {
+				_rehash(capacity() ? capacity() * 2 : 16);
+			}
+			value_type entry = { key, V() };
+			_insert(entry);
+			return find(key)->second;
+		}
+
+		// erase by iterator.
+		void erase(const iterator &it) {
+			if (it != end()) _erase(it.pos());
+		}
+
+		// erase by key, return erased count.
+		unsigned int erase(key_type key) {
+			iterator it = find(key);
+			if (it == end()) return 0;
+			_erase(it.pos());
+			return 1;
+		}
+
+		// remove all entries but keep capacity.
+		void clear() {
+			if (m_size == 0) return;
+			m_dist.assign(m_dist.size(), 0);
+			m_size = 0;
+		}
+
+		// make room for count entries without rehash.
+		void reserve(unsigned int count) {
+			unsigned int cap = capacity() ? capacity() : 16;
+			while (count * load_den > cap * load_num) cap *= 2;
+			if (cap > capacity()) _rehash(cap);
+		}
+
+	protected:
+		// mix bits, continuous ids are common.
+		static unsigned int _hash(key_type key) {
+			return (unsigned int)mix_key(key);
+		}
+
+		// robin hood insertion: poor entry takes rich one's place.
+		void _insert(value_type entry) {
+			unsigned int mask = capacity() - 1;
+			unsigned int pos = _hash(entry.first) & mask;
+			unsigned char dist = 1;
+			for (;;) {
+				if (m_dist[pos] == 0) {
+					m_slots[pos] = std::move(entry);
+					m_dist[pos] = dist;
+					m_size++;
+					return;
+				}
+				if (m_dist[pos] < dist) {
+					std::swap(m_slots[pos], entry);
+					std::swap(m_dist[pos], dist);
+				}
+				pos = (pos + 1) & mask;
+
+				// probe too long, grow and insert the carried entry again.
+				if (++dist == 0xFF) {
+					_rehash(capacity() * 2);
+					_insert(std::move(entry));
+					return;
+				}
+			}
+		}
+
+		// backward shift deletion.
+		void _erase(unsigned int pos) {
+			unsigned int mask = capacity() - 1;
+			unsigned int next = (pos + 1) & mask;
+			while (m_dist[next] > 1) {
+				m_slots[pos] = std::move(m_slots[next]);
+				m_dist[pos] = m_dist[next] - 1;
+				pos = next;
+				next = (next + 1) & mask;
+			}
+			m_dist[pos] = 0;
+			m_size--;
+		}
+
+		void _rehash(unsigned int cap) {
+			std::vector<value_type> slots(cap);
+			std::vector<unsigned char> dist(cap, 0);
+			slots.swap(m_slots);
+			dist.swap(m_dist);
+			m_size = 0;
+			for (unsigned int i = 0; i < (unsigned int)dist.size(); i++) {
+				if (dist[i] != 0) {
+					_insert(std::move(slots[i]));
+				}
+			}
+		}
+
+	private:
+		// entries.
+		std::vector<value_type>    m_slots;
+
+		// probe distance + 1 of every entry, 0 is empty.
+		std::vector<unsigned char> m_dist;
+
+		// entry count.
+		unsigned int               m_size;
+	};
+}
@@ -0,0 +1,148 @@
+
+// note  : move only callable with inline storage, used as timer callback.
+// idea  : callable(lambda and its captures) lives in the object itself if it fits
+//         TIMER_FUNC_INLINE_SIZE, so adding a timer needs no memory allocation.
+//         larger callable goes to heap, or it is a compile error if TIMER_FUNC_NO_HEAP defined.
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// inline storage size of timer callback.
+#ifndef TIMER_FUNC_INLINE_SIZE
+#define TIMER_FUNC_INLINE_SIZE 48
+#endif
+
+namespace STimeWheelSpace {
+	template <class Sig, unsigned int Size>
+	class CInlineFunc;
+
+	template <class R, class... Args, unsigned int Size>
+	class CInlineFunc<R(Args...), Size> final {
+	protected:
+		// operations of stored callable type.
+		typedef struct {
+			R(*invoke)(void *obj, Args&&... args);
+			void(*move)(void *dst, void *src);  // move src to dst and destroy src.
+			void(*destroy)(void *obj);
+		} func_ops;
+
+		// callable can be stored inline.
+		template <class F>
+		struct is_inline : std::integral_constant<bool,
+			sizeof(F) <= Size && alignof(F) <= alignof(std::max_align_t) &&
+			std::is_nothrow_move_constructible<F>::value> {};
+
+		// inline callable ops.
+		template <class F>
+		struct inline_ops {
+			static R invoke(void *obj, Args&&... args) {
+				return (*static_cast<F*>(obj))(std::forward<Args>(args)...);
+			}
+			static void move(void *dst, void *src) {
+				new (dst) F(std::move(*static_cast<F*>(src)));
+				static_cast<F*>(src)->~F();
+			}
+			static void destroy(void *obj) {
+				static_cast<F*>(obj)->~F();
+			}
+			static constexpr func_ops ops = { &invoke, &move, &destroy };
+		};
+
+		// heap callable ops, storage holds the pointer.
+		template <class F>
+		struct heap_ops {
+			static R invoke(void *obj, Args&&... args) {
+				return (**static_cast<F**>(obj))(std::forward<Args>(args)...);
+			}
+			static void move(void *dst, void *src) {
+				*static_cast<F**>(dst) = *static_cast<F**>(src);
+			}
+			static void destroy(void *obj) {
+				delete *static_cast<F**>(obj);
+			}
+			static constexpr func_ops ops = { &invoke, &move, &destroy };
+		};
+
+	public:
+		CInlineFunc() : m_ops(nullptr) {}
+		CInlineFunc(std::nullptr_t) : m_ops(nullptr) {}
+
+		// any callable, it is moved in if it is right value.
+		template <class F, class D = typename std::decay<F>::type,
+			class = typename std::enable_if<!std::is_same<D, CInlineFunc>::value>::type>
+		CInlineFunc(F&& func) : m_ops(nullptr) {
+			this->_store<D>(std::forward<F>(func), is_inline<D>());
+		}
+
+		CInlineFunc(CInlineFunc&& rhs) noexcept : m_ops(rhs.m_ops) {
+			if (m_ops) {
+				m_ops->move(m_buf, rhs.m_buf);
+				rhs.m_ops = nullptr;
+			}
+		}
+
+		CInlineFunc& operator=(CInlineFunc&& rhs) noexcept {
+			if (this != &rhs) {
+				this->reset();
+				if ((m_ops = rhs.m_ops)) {
+					m_ops->move(m_buf, rhs.m_buf);
+					rhs.m_ops = nullptr;
+				}
+			}
+			return *this;
+		}
+
+		CInlineFunc& operator=(std::nullptr_t) {
+			this->reset();
+			return *this;
+		}
+
+		~CInlineFunc() { this->reset(); }
+
+		// can not copyable class.
+		CInlineFunc(const CInlineFunc& rhs) = delete;
+		const CInlineFunc& operator=(const CInlineFunc& rhs) = delete;
+
+	public:
+		R operator()(Args... args) const {
+			return m_ops->invoke(const_cast<unsigned char*>(m_buf), std::forward<Args>(args)...);
+		}
+
+		explicit operator bool() const { return m_ops != nullptr; }
+
+		// destroy callable.
+		void reset() {
+			if (m_ops) {
+				m_ops->destroy(m_buf);
+				m_ops = nullptr;
+			}
+		}
+
+	protected:
+		template <class D, class F>
+		void _store(F&& func, std::true_type) {
+			new (m_buf) D(std::forward<F>(func));
+			m_ops = &inline_ops<D>::ops;
+		}
+
+		template <class D, class F>
+		void _store(F&& func, std::false_type) {
+#if defined(TIMER_FUNC_NO_HEAP)
+			static_assert(sizeof(D) == 0, "callable is larger than TIMER_FUNC_INLINE_SIZE");
+#endif
+			*reinterpret_cast<D**>(m_buf) = new D(std::forward<F>(func));
+			m_ops = &heap_ops<D>::ops;
+		}
+
+	private:
+		// callable storage.
+		alignas(std::max_align_t) unsigned char m_buf[Size < sizeof(void*) ? sizeof(void*) : Size];
+
+		// callable ops, nullptr if it is empty.
+		const func_ops *m_ops;
+	};
+}
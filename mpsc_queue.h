@@ -0,0 +1,110 @@
+
+// note  : bounded lock-free multi-producer single-consumer queue.
+// idea  : ring of cells with sequence numbers(vyukov), a producer claims a cell
+//         by CAS on tail and publishes it by its sequence, the consumer owns head,
+//         so push and pop never lock, and push fails only if the ring is full.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <assert.h>
+
+namespace STimeWheelSpace {
+	template <class T>
+	class CMpscQueue final {
+	protected:
+		typedef struct cell {
+			std::atomic<size_t> seq;     // sequence of cell.
+			T                   value;   // stored value.
+		} cell;
+
+		// keep producer and consumer index at different cache lines.
+		static constexpr size_t cache_line = 64;
+
+	public:
+		CMpscQueue() : m_mask(0), m_head(0), m_tail(0) {}
+		~CMpscQueue() = default;
+		// can not copyable class.
+		const CMpscQueue& operator=(const CMpscQueue& rhs) = delete;
+		CMpscQueue(const CMpscQueue& rhs) = delete;
+
+	public:
+		// init with capacity, it is rounded up to power of 2.
+		bool init(size_t size) {
+			if (size < 2) size = 2;
+			size_t cap = 1;
+			while (cap < size) cap <<= 1;
+
+			m_cells.reset(new cell[cap]);
+			if (!m_cells) return false;
+			for (size_t i = 0; i < cap; i++) {
+				m_cells[i].seq.store(i, std::memory_order_relaxed);
+			}
+			m_mask = cap - 1;
+			m_head = 0;
+			m_tail.store(0, std::memory_order_relaxed);
+			return true;
+		}
+
+		// capacity.
+		size_t capacity() const { return m_cells ? m_mask + 1 : 0; }
+
+		// push from any thread, return false if it is full.
+		bool push(T &&value) {
+			assert(m_cells && "queue is not init");
+			size_t pos = m_tail.load(std::memory_order_relaxed);
+			for (;;) {
+				cell *c = &m_cells[pos & m_mask];
+				size_t seq = c->seq.load(std::memory_order_acquire);
+				intptr_t diff = intptr_t(seq) - intptr_t(pos);
+				if (diff == 0) {
+					if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						c->value = std::move(value);
+						c->seq.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				} else if (diff < 0) {
+					return false; // full.
+				} else {
+					pos = m_tail.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// it is empty, at consumer thread only.
+		bool empty() const {
+			if (!m_cells) return true;
+			const cell *c = &m_cells[m_head & m_mask];
+			return intptr_t(c->seq.load(std::memory_order_acquire)) - intptr_t(m_head + 1) < 0;
+		}
+
+		// pop at consumer thread only, return false if it is empty.
+		bool pop(T &value) {
+			if (!m_cells) return false;
+			cell *c = &m_cells[m_head & m_mask];
+			size_t seq = c->seq.load(std::memory_order_acquire);
+			if (intptr_t(seq) - intptr_t(m_head + 1) < 0) {
+				return false;
+			}
+			value = std::move(c->value);
+			c->seq.store(m_head + m_mask + 1, std::memory_order_release);
+			m_head++;
+			return true;
+		}
+
+	private:
+		// cells.
+		std::unique_ptr<cell[]> m_cells;
+
+		// index mask.
+		size_t                  m_mask;
+
+		// consumer index.
+		alignas(cache_line) size_t m_head;
+
+		// producer index.
+		alignas(cache_line) std::atomic<size_t> m_tail;
+	};
+}
@@ -0,0 +1,239 @@
+
+// note  : indexed node pool for time wheel.
+// idea  : nodes live in slabs whose size doubles(slab k has base << k nodes), so a node
+//         is found by its index in O(1) with a count-leading-zeros, growing to millions
+//         of nodes needs few allocations, and a fully free slab can be given back.
+//         every index has a generation(kept aside, so it lives on when slab is trimmed)
+//         which is increased when node is released, so (index, generation) is a handle
+//         which can be checked without any map.
+//         every index has a hot node(T) and a cold entry(C) in parallel slabs, so the
+//         hot nodes walked by the wheel are dense and cold data is touched at need only.
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <assert.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace STimeWheelSpace {
+	// floor(log2(v)), v must not be 0.
+	inline unsigned int bit_log2(unsigned int v) {
+#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanReverse(&index, v);
+		return (unsigned int)index;
+#else
+		return 31u - (unsigned int)__builtin_clz(v);
+#endif
+	}
+
+	template <class T, class C>
+	class CNodePool final {
+	public:
+		// max slab count.
+		static constexpr unsigned int max_slabs = 32;
+
+	public:
+		CNodePool() : m_base(0), m_shift(0), m_slab_count(0), m_capacity(0), m_used(0) {
+			for (unsigned int k = 0; k < max_slabs; k++) {
+				m_slabs[k] = nullptr;
+				m_colds[k] = nullptr;
+				m_slab_used[k] = 0;
+			}
+		}
+		~CNodePool() {
+			// live nodes must be released by owner first.
+			assert(m_used == 0 && "node pool is still in use");
+			for (unsigned int k = 0; k < m_slab_count; k++) {
+				if (m_slabs[k]) {
+					this->_deallocate(k);
+				}
+			}
+		}
+		// can not copyable class.
+		const CNodePool& operator=(const CNodePool& rhs) = delete;
+		CNodePool(const CNodePool& rhs) = delete;
+
+	public:
+		// init with start node count and first slab size(rounded up to power of 2).
+		bool init(unsigned int start_size, unsigned int grow_size) {
+			if (grow_size == 0 || m_base != 0) return false;
+			m_base = 1;
+			while (m_base < grow_size) m_base <<= 1;
+			m_shift = bit_log2(m_base);
+			return this->reserve(start_size);
+		}
+
+		// fetch a constructed node(and its cold entry) and its index.
+		T* fetch_obj(unsigned int &index) {
+			if (m_free.empty() && !_grow()) {
+				return nullptr;
+			}
+
+			index = m_free.back();
+			m_free.pop_back();
+			m_used++;
+			m_slab_used[_slab(index)]++;
+			new (_cold_at(index)) C();
+			return new (_at(index)) T();
+		}
+
+		// destroy node and its cold entry, make its handles invalid.
+		void release_obj(T *obj, unsigned int index) {
+			assert(obj == _at(index) && "node index error");
+			obj->~T();
+			_cold_at(index)->~C();
+			if (++m_gens[index] == 0) { // 0 is invalid generation.
+				m_gens[index] = 1;
+			}
+			m_free.push_back(index);
+			m_used--;
+			m_slab_used[_slab(index)]--;
+		}
+
+		// make room for count more nodes without growing at fetch.
+		bool reserve(unsigned int count) {
+			while (m_free.size() < count) {
+				if (!_grow()) return false;
+			}
+			return true;
+		}
+
+		// give fully free slabs back(from the largest), but keep room for keep more nodes.
+		// return released node count.
+		unsigned int trim(unsigned int keep = 0) {
+			unsigned int released = 0;
+			for (unsigned int k = m_slab_count; k-- > 0;) {
+				if (!m_slabs[k] || m_slab_used[k] != 0) continue;
+				if (m_capacity - m_used < keep + _slab_size(k)) continue;
+
+				this->_deallocate(k);
+				m_capacity -= _slab_size(k);
+				released += _slab_size(k);
+			}
+			if (released == 0) return 0;
+
+			// drop indexes of released slabs, lower index is fetched first.
+			m_free.erase(std::remove_if(m_free.begin(), m_free.end(), [this](unsigned int index) {
+				return m_slabs[_slab(index)] == nullptr;
+			}), m_free.end());
+			std::sort(m_free.begin(), m_free.end(), [](unsigned int a, unsigned int b) { return a > b; });
+			m_free.shrink_to_fit();
+			return released;
+		}
+
+		// node of (index, generation), nullptr if it is released.
+		T* find(unsigned int index, unsigned int gen) const {
+			if (index >= m_gens.size() || m_gens[index] != gen) {
+				return nullptr;
+			}
+			return _at(index);
+		}
+
+		// cold entry of a used index.
+		C* cold(unsigned int index) const { return _cold_at(index); }
+
+		// current generation of index.
+		unsigned int generation(unsigned int index) const { return m_gens[index]; }
+
+		// all node count(of allocated slabs).
+		unsigned int capacity() const { return m_capacity; }
+
+		// used node count.
+		unsigned int used() const { return m_used; }
+
+		// bytes held by slabs, generations and free indexes.
+		size_t bytes_held() const {
+			return size_t(m_capacity) * (sizeof(T) + sizeof(C)) + m_gens.capacity() * sizeof(unsigned int)
+				+ m_free.capacity() * sizeof(unsigned int);
+		}
+
+		// bytes of used nodes.
+		size_t bytes_live() const { return size_t(m_used) * (sizeof(T) + sizeof(C)); }
+
+	protected:
+		// slab k holds index [base * (2^k - 1), base * (2^(k+1) - 1)).
+		unsigned int _slab(unsigned int index) const {
+			return bit_log2((index >> m_shift) + 1);
+		}
+		unsigned int _slab_start(unsigned int k) const { return m_base * ((1u << k) - 1); }
+		unsigned int _slab_size(unsigned int k) const { return m_base << k; }
+
+		T* _at(unsigned int index) const {
+			unsigned int k = _slab(index);
+			return m_slabs[k] + (index - _slab_start(k));
+		}
+		C* _cold_at(unsigned int index) const {
+			unsigned int k = _slab(index);
+			return m_colds[k] + (index - _slab_start(k));
+		}
+
+		bool _grow() {
+			// a trimmed slab first, then a new larger one.
+			unsigned int k = 0;
+			while (k < m_slab_count && m_slabs[k]) k++;
+			if (m_base == 0 || k >= max_slabs) return false;
+			if (k == m_slab_count && (unsigned long long)m_base * ((2ull << k) - 1) > 0xFFFFFFFFull) {
+				return false;
+			}
+
+			T *slab = std::allocator<T>().allocate(_slab_size(k));
+			if (!slab) return false;
+			m_colds[k] = std::allocator<C>().allocate(_slab_size(k));
+			m_slabs[k] = slab;
+			m_capacity += _slab_size(k);
+			if (k == m_slab_count) {
+				m_slab_count++;
+				m_gens.resize(_slab_start(k) + _slab_size(k), 1);
+			}
+
+			// lower index is fetched first.
+			unsigned int start = _slab_start(k);
+			for (unsigned int i = _slab_size(k); i > 0; i--) {
+				m_free.push_back(start + i - 1);
+			}
+			return true;
+		}
+
+		void _deallocate(unsigned int k) {
+			std::allocator<T>().deallocate(m_slabs[k], _slab_size(k));
+			std::allocator<C>().deallocate(m_colds[k], _slab_size(k));
+			m_slabs[k] = nullptr;
+			m_colds[k] = nullptr;
+		}
+
+	private:
+		// node count of first slab(power of 2) and its shift.
+		unsigned int              m_base;
+		unsigned int              m_shift;
+
+		// slab count(trimmed ones too).
+		unsigned int              m_slab_count;
+
+		// node count of allocated slabs.
+		unsigned int              m_capacity;
+
+		// used node count.
+		unsigned int              m_used;
+
+		// slabs, nullptr if it is trimmed.
+		T                        *m_slabs[max_slabs];
+
+		// cold entry slabs, parallel to m_slabs.
+		C                        *m_colds[max_slabs];
+
+		// used node count of every slab.
+		unsigned int              m_slab_used[max_slabs];
+
+		// generation of every index.
+		std::vector<unsigned int> m_gens;
+
+		// free indexes.
+		std::vector<unsigned int> m_free;
+	};
+}
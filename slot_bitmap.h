@@ -0,0 +1,107 @@
+
+// note  : two level occupancy bitmap for wheel slots.
+// idea  : a bit for every slot and a summary bit for every word,
+//         so finding next non-empty slot costs some count-trailing-zeros.
+
+#pragma once
+
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace STimeWheelSpace {
+	// count trailing zeros, v must not be 0.
+	inline unsigned int bit_ctz(unsigned long long v) {
+#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanForward64(&index, v);
+		return (unsigned int)index;
+#else
+		return (unsigned int)__builtin_ctzll(v);
+#endif
+	}
+
+	// slot occupancy bitmap.
+	class CSlotBitmap final {
+	public:
+		typedef unsigned long long word_type;
+		static constexpr unsigned int word_bits = 64;
+
+	public:
+		CSlotBitmap() : m_size(0) {}
+		~CSlotBitmap() = default;
+
+		// init with slot count, all slots are empty.
+		void init(unsigned int size) {
+			m_size = size;
+			m_words.assign((size + word_bits - 1) / word_bits, 0);
+			m_summary.assign((m_words.size() + word_bits - 1) / word_bits, 0);
+		}
+
+		// slot count.
+		unsigned int size() const { return m_size; }
+
+		// slot is occupied.
+		bool test(unsigned int index) const {
+			return (m_words[index / word_bits] >> (index % word_bits)) & 1;
+		}
+
+		// mark slot occupied.
+		void set(unsigned int index) {
+			unsigned int w = index / word_bits;
+			m_words[w] |= word_type(1) << (index % word_bits);
+			m_summary[w / word_bits] |= word_type(1) << (w % word_bits);
+		}
+
+		// mark slot empty.
+		void reset(unsigned int index) {
+			unsigned int w = index / word_bits;
+			m_words[w] &= ~(word_type(1) << (index % word_bits));
+			if (m_words[w] == 0) {
+				m_summary[w / word_bits] &= ~(word_type(1) << (w % word_bits));
+			}
+		}
+
+		// first occupied slot in [from, end), return end if there is none.
+		unsigned int find_next(unsigned int from, unsigned int end) const {
+			if (from >= end) return end;
+
+			// the rest of from's word.
+			unsigned int w = from / word_bits;
+			word_type bits = m_words[w] & (~word_type(0) << (from % word_bits));
+			if (bits) {
+				return _found(w * word_bits + bit_ctz(bits), end);
+			}
+
+			// next non-empty word by summary.
+			unsigned int next = w + 1;
+			unsigned int words = (unsigned int)m_words.size();
+			while (next < words && next * word_bits < end) {
+				unsigned int s = next / word_bits;
+				word_type sbits = m_summary[s] & (~word_type(0) << (next % word_bits));
+				if (sbits) {
+					w = s * word_bits + bit_ctz(sbits);
+					return _found(w * word_bits + bit_ctz(m_words[w]), end);
+				}
+				next = (s + 1) * word_bits;
+			}
+			return end;
+		}
+
+	protected:
+		static unsigned int _found(unsigned int index, unsigned int end) {
+			return index < end ? index : end;
+		}
+
+	private:
+		// slot count.
+		unsigned int           m_size;
+
+		// a bit for every slot.
+		std::vector<word_type> m_words;
+
+		// a bit for every non-empty word.
+		std::vector<word_type> m_summary;
+	};
+}
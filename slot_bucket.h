@@ -0,0 +1,118 @@
+
+// note  : array slot bucket for wheel slots(TIME_WHEEL_SOA_SLOTS mode).
+// idea  : a slot keeps expire ticks and nodes in two parallel arrays(structure of arrays),
+//         so finding due timers is a compare over contiguous expire ticks(4 at a time
+//         with avx2), not a pointer chase of linked nodes, and a timer is removed by
+//         swap-remove with its position.
+
+#pragma once
+
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace STimeWheelSpace {
+	template <class T>
+	class CSlotBucket final {
+	public:
+		CSlotBucket() = default;
+		~CSlotBucket() = default;
+		// can not copyable class.
+		const CSlotBucket& operator=(const CSlotBucket& rhs) = delete;
+		CSlotBucket(const CSlotBucket& rhs) = delete;
+
+	public:
+		// node count.
+		unsigned int size() const { return (unsigned int)m_nodes.size(); }
+		bool empty() const { return m_nodes.empty(); }
+
+		// add node, return its position.
+		unsigned int push(unsigned long long expire, T *node) {
+			m_expires.push_back(expire);
+			m_nodes.push_back(node);
+			return (unsigned int)m_nodes.size() - 1;
+		}
+
+		// remove node at pos by moving the last one there,
+		// return the moved node(its position is pos now), nullptr if it is the last.
+		T* remove(unsigned int pos) {
+			unsigned int last = (unsigned int)m_nodes.size() - 1;
+			T *moved = nullptr;
+			if (pos != last) {
+				m_expires[pos] = m_expires[last];
+				m_nodes[pos] = m_nodes[last];
+				moved = m_nodes[pos];
+			}
+			m_expires.pop_back();
+			m_nodes.pop_back();
+			return moved;
+		}
+
+		// take all nodes in array order.
+		template <class Take>
+		void take_all(Take &&take) {
+			for (T *node : m_nodes) {
+				take(node);
+			}
+			m_expires.clear();
+			m_nodes.clear();
+		}
+
+		// take nodes whose expire < limit in array order, the others are kept in order,
+		// keep(node, pos) is called for a kept node whose position is changed.
+		template <class Take, class Keep>
+		void take_due(unsigned long long limit, Take &&take, Keep &&keep) {
+			unsigned int count = (unsigned int)m_nodes.size();
+			unsigned int kept = 0;
+			unsigned int i = 0;
+#if defined(__AVX2__)
+			// ticks are far less than 2^63, so signed compare is right.
+			const __m256i vlimit = _mm256_set1_epi64x((long long)limit);
+			for (; i + 4 <= count; i += 4) {
+				__m256i vexpire = _mm256_loadu_si256((const __m256i*)&m_expires[i]);
+				int due = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(vlimit, vexpire)));
+				if (due == 0xF) { // all due.
+					for (unsigned int j = i; j < i + 4; j++) {
+						take(m_nodes[j]);
+					}
+					continue;
+				}
+				for (unsigned int j = i; j < i + 4; j++) {
+					if (due & (1 << (j - i))) {
+						take(m_nodes[j]);
+					} else {
+						this->_keep(j, kept++, keep);
+					}
+				}
+			}
+#endif
+			for (; i < count; i++) {
+				if (m_expires[i] < limit) {
+					take(m_nodes[i]);
+				} else {
+					this->_keep(i, kept++, keep);
+				}
+			}
+			m_expires.resize(kept);
+			m_nodes.resize(kept);
+		}
+
+	protected:
+		// move kept node from to pos.
+		template <class Keep>
+		void _keep(unsigned int from, unsigned int pos, Keep &keep) {
+			if (from == pos) return;
+			m_expires[pos] = m_expires[from];
+			m_nodes[pos] = m_nodes[from];
+			keep(m_nodes[pos], pos);
+		}
+
+	private:
+		// expire tick of every node.
+		std::vector<unsigned long long> m_expires;
+
+		// nodes.
+		std::vector<T*>                 m_nodes;
+	};
+}
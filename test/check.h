@@ -0,0 +1,14 @@
+
+// note  : check macro of self-checking tests, a failed check exits with 1.
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+#define CHECK(expr) do { \
+	if (!(expr)) { \
+		printf("%s:%d check fail: %s\n", __FILE__, __LINE__, #expr); \
+		exit(1); \
+	} \
+} while (0)
@@ -0,0 +1,45 @@
+
+// note  : bulk add of register gives the same ids and replacing as adding specs one by one.
+
+#include "check.h"
+#include "time_wheel.h"
+
+using namespace STimeWheelSpace;
+
+int main() {
+	CTimeWheel wheel;
+	CTimerRegister reg(wheel);
+	uint64 fired[4] = { 0 };
+	uint32 count = 0;
+
+	// same id: the later spec replaces the earlier one.
+	timer_spec specs[2];
+	specs[0].func = [&](void*) { fired[count++] = 100; };
+	specs[0].id = 5; specs[0].delay = 100; specs[0].timerType = onceType;
+	specs[1].func = [&](void*) { fired[count++] = 50; };
+	specs[1].id = 5; specs[1].delay = 50; specs[1].timerType = onceType;
+	add_timer_ret results[2];
+	CHECK(reg.add_timers(specs, 2, results) == 2);
+	CHECK(results[0] == ADD_TIMER_SUCC);
+	CHECK(results[1] == EXIST_REMOVE_RET);
+	CHECK(reg.get_timer_count() == 1);
+	CHECK(reg.get_left_time(5) == 50);
+	wheel.update(200);
+	CHECK(count == 1 && fired[0] == 50);
+
+	// invalid_timer_id: next ids are given in spec order.
+	uint64 first = reg.next_id();
+	specs[0].func = [&](void*) { fired[count++] = 100; };
+	specs[0].id = invalid_timer_id; specs[0].delay = 100;
+	specs[1].func = [&](void*) { fired[count++] = 50; };
+	specs[1].id = invalid_timer_id; specs[1].delay = 50;
+	CHECK(reg.add_timers(specs, 2) == 2);
+	CHECK(reg.get_left_time(first) == 100);
+	CHECK(reg.get_left_time(first + 1) == 50);
+	wheel.update(200);
+	CHECK(count == 3 && fired[1] == 50 && fired[2] == 100);
+	CHECK(wheel.get_all_timer() == 0);
+
+	printf("test_bulk_add ok\n");
+	return 0;
+}
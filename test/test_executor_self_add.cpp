@@ -0,0 +1,47 @@
+
+// note  : executor callback adds to its own shard while the shard post queue is full.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "check.h"
+#include "timer_executor.h"
+
+using namespace STimeWheelSpace;
+
+int main() {
+	// one shard, post queue of 4 commands.
+	CTimerExecutor executor(1, default_geometry, 4);
+	CHECK(executor.start());
+
+	std::atomic<uint32> added(0);
+	std::atomic<uint32> fired(0);
+	std::atomic<bool> done(false);
+	uint64 ticket = executor.add_once_timer(1, [&](void*) {
+		for (int i = 0; i < 8; i++) {
+			if (executor.add_once_timer(1, [&fired](void*) { fired++; }, 1)) {
+				added++;
+			}
+		}
+		done = true;
+	}, 1);
+	CHECK(ticket != 0);
+
+	for (int i = 0; i < 2000 && fired < 8; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	CHECK(done);
+	CHECK(added == 8);
+	CHECK(fired == 8);
+
+	// a thread which does not own the shard fails at full queue, it does not wait.
+	executor.stop();
+	uint32 posted = 0;
+	for (int i = 0; i < 8; i++) {
+		posted += executor.add_once_timer(1, [](void*) {}, 1000) != 0;
+	}
+	CHECK(posted == 4);
+
+	printf("test_executor_self_add ok\n");
+	return 0;
+}
@@ -0,0 +1,59 @@
+
+// note  : left time of a repeated timer whose callback is still running at dispatcher.
+
+#include <vector>
+#include "check.h"
+#include "time_wheel.h"
+
+using namespace STimeWheelSpace;
+
+// dispatcher which holds tasks until they are run by hand(dispatch is in flight).
+class CHoldDispatcher : public CTimerDispatcher {
+public:
+	virtual void dispatch(dispatch_task *tasks, uint32 count) override {
+		for (uint32 i = 0; i < count; i++) {
+			m_tasks.emplace_back(std::move(tasks[i]));
+		}
+	}
+
+	void run() {
+		for (auto &task : m_tasks) task();
+		m_tasks.clear();
+	}
+
+	size_t size() const { return m_tasks.size(); }
+
+protected:
+	std::vector<dispatch_task> m_tasks;
+};
+
+int main() {
+	CHoldDispatcher dispatcher;
+	CTimeWheel wheel;
+	wheel.set_dispatcher(&dispatcher);
+
+	uint32 fired = 0;
+	timer_handle handle = wheel.add_repeated_timer([&fired](void*) { fired++; }, 10);
+	CHECK(wheel.get_left_time(handle) == 10);
+
+	// expired: its callback is handed to dispatcher and it is not done yet.
+	wheel.update(11);
+	CHECK(dispatcher.size() == 1);
+	CHECK(wheel.has_timer(handle));
+	CHECK(wheel.get_left_time(handle) == 0);
+
+	// ticks go on while dispatch is in flight.
+	wheel.update(5);
+	CHECK(wheel.get_left_time(handle) == 0);
+
+	// done: it is armed again from current tick.
+	dispatcher.run();
+	CHECK(fired == 1);
+	wheel.update(0);
+	CHECK(wheel.has_timer(handle));
+	CHECK(wheel.get_left_time(handle) > 0 && wheel.get_left_time(handle) <= 10);
+
+	wheel.set_dispatcher(nullptr);
+	printf("test_left_time_dispatched ok\n");
+	return 0;
+}
@@ -0,0 +1,54 @@
+
+// note  : pool occupancy tracks live timers: killed and replaced timers go back to pool at once.
+
+#include "check.h"
+#include "time_wheel.h"
+
+using namespace STimeWheelSpace;
+
+int main() {
+	const uint32 count = 10000;
+	const uint32 killed = 3000;
+	CTimeWheel wheel;
+	CTimerRegister reg(wheel);
+	uint32 fired = 0;
+
+	// handle timers: killed ones are released at kill time, not when wheel reaches them.
+	timer_handle handles[count];
+	for (uint32 i = 0; i < count; i++) {
+		handles[i] = wheel.add_once_timer([&fired](void*) { fired++; }, 1000 + int32(i % 3600) * 1000);
+		CHECK(bool(handles[i]));
+	}
+	CHECK(wheel.get_all_timer() == count);
+	size_t live = wheel.get_pool_live();
+	for (uint32 i = 0; i < killed; i++) {
+		CHECK(wheel.kill_timer(handles[i * 3]));
+	}
+	CHECK(wheel.get_all_timer() == count - killed);
+	CHECK(wheel.get_killed_timer() == 0);
+	CHECK(wheel.get_pool_live() < live);
+
+	// register timers: kill and replace release the old timer right now too.
+	for (uint32 id = 1; id <= count; id++) {
+		CHECK(reg.add_once_timer([&fired](void*) { fired++; }, id, 60 * 60 * 1000) == ADD_TIMER_SUCC);
+	}
+	CHECK(wheel.get_all_timer() == 2 * count - killed);
+	for (uint32 id = 1; id <= killed; id++) {
+		CHECK(reg.kill_timer(id));
+	}
+	for (uint32 id = killed + 1; id <= 2 * killed; id++) {
+		CHECK(reg.add_once_timer([&fired](void*) { fired++; }, id, 500) == EXIST_REMOVE_RET);
+	}
+	CHECK(reg.get_timer_count() == count - killed);
+	CHECK(wheel.get_all_timer() == 2 * (count - killed));
+
+	// all expired: pool is empty.
+	wheel.update(2 * 60 * 60 * 1000);
+	CHECK(fired == 2 * (count - killed));
+	CHECK(wheel.get_all_timer() == 0);
+	CHECK(wheel.get_pool_live() == 0);
+	CHECK(reg.get_timer_count() == 0);
+
+	printf("test_pool_occupancy ok\n");
+	return 0;
+}
@@ -0,0 +1,86 @@
+
+// note  : wakeup lateness of timerfd driver in an epoll loop(linux only):
+//         every wakeup is measured against the time of the wheel's next expiry.
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "timer_fd.h"
+
+#if defined(__linux__)
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+using namespace STimeWheelSpace;
+
+static int64 now_us() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main() {
+	const int count = 200;
+	CTimeWheel wheel;
+	CTimerFdDriver driver(wheel);
+	CHECK(driver.init());
+	int ep = epoll_create1(0);
+	CHECK(ep >= 0);
+	epoll_event ev = {};
+	ev.events = EPOLLIN;
+	ev.data.fd = driver.fd();
+	CHECK(epoll_ctl(ep, EPOLL_CTL_ADD, driver.fd(), &ev) == 0);
+
+	// timers added at io thread, and one posted from another thread.
+	int fired = 0;
+	for (int i = 0; i < count; i++) {
+		wheel.add_once_timer([&fired](void*) { fired++; }, 3 + (i * 7) % 97);
+	}
+	driver.rearm();
+	std::thread poster([&wheel, &fired]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(30));
+		CHECK(wheel.post_once_timer([&fired](void*) { fired++; }, 5) != 0);
+	});
+
+	std::vector<int64> late;
+	while (fired < count + 1) {
+		uint64 next = wheel.next_expiry();
+		int64 due = (next == no_expiry) ? 0 : wheel.get_tick_time(next);
+		epoll_event out[4];
+		CHECK(epoll_wait(ep, out, 4, 1000) > 0);
+		// a posted wakeup is not late for any expiry.
+		int64 now = now_us();
+		if (due && now >= due) {
+			late.push_back(now - due);
+		}
+		driver.on_readable();
+	}
+	poster.join();
+	CHECK(wheel.get_all_timer() == 0);
+
+	// idle: no wakeup.
+	epoll_event out;
+	CHECK(epoll_wait(ep, &out, 1, 50) == 0);
+	close(ep);
+
+	CHECK(!late.empty());
+	std::sort(late.begin(), late.end());
+	int64 p50 = late[late.size() / 2];
+	int64 p99 = late[late.size() * 99 / 100];
+	// sub-ms at the median, a loaded host may be late sometimes.
+	CHECK(p50 < 1000);
+	printf("test_timerfd_lateness ok: %zu wakeups, late p50 %lldus p99 %lldus max %lldus\n",
+		late.size(), (long long)p50, (long long)p99, (long long)late.back());
+	return 0;
+}
+
+#else
+
+int main() {
+	printf("test_timerfd_lateness skipped: linux only\n");
+	return 0;
+}
+
+#endif
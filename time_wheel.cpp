@@ -1,8 +1,11 @@
 #include "time_wheel.h"
+#include "timer_thread_pool.h"
 #include <assert.h>
 #include <cassert>
 #include <string.h>
 #include <stdio.h>
+#include <chrono>
+#include <limits>
 
 #if !defined(_WIN32)
 // as windows GetTickCount() function.
@@ -23,6 +26,47 @@ namespace STimeWheelSpace {
 		return GetTickCount();
 	}
 
+	// monotonic time, unit: us
+	static int64 get_system_time_us() {
+		return int64(std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	// coarse monotonic time, unit: us, it is cheap but late a jiffy at most.
+	static int64 get_coarse_time_us() {
+#if defined(CLOCK_MONOTONIC_COARSE)
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+		return int64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#else
+		return get_system_time_us();
+#endif
+	}
+
+	// resolution of coarse monotonic time, unit: us.
+	static int64 get_coarse_res_us() {
+#if defined(CLOCK_MONOTONIC_COARSE)
+		struct timespec ts;
+		if (clock_getres(CLOCK_MONOTONIC_COARSE, &ts) == 0) {
+			return int64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000 + 1;
+		}
+		return 10000;
+#else
+		return 0;
+#endif
+	}
+
+	// cpu hint in spin loop.
+	static inline void cpu_relax() {
+#if defined(_MSC_VER)
+		YieldProcessor();
+#elif defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#elif defined(__aarch64__)
+		asm volatile("yield");
+#endif
+	}
+
 	// safe copy string
 	static inline void safeCopy(char *des, int des_len, const char *src) {
 		if (!des || des_len <= 0) return;
@@ -40,24 +84,19 @@ namespace STimeWheelSpace {
 		}
 	}
 
-	/// all kinds of macros start.
-	// timer para check.
-#define check_timer_para(delay, repeat)                   \
-	if ((delay) < 0) {                                    \
-		assert(false && "delay time error");              \
-		return nullptr;                                   \
-	}                                                     \
-	assert(!((delay) == 0 && (repeat) > 0) && "circle timer");\
-	if (delay == 0 && repeat > 0) {                       \
-		return nullptr;                                   \
+	// attach of all kinds of data.
+	static inline attach to_attach(const attach &data) { return data; }
+	static inline attach to_attach(void *data) { attach a; a.pvalue = data; return a; }
+	static inline attach to_attach(int64 data) { attach a; a.ivalue = data; return a; }
+	static inline attach to_attach(uint64 data) { attach a; a.uvalue = data; return a; }
+	static inline attach to_attach(decimal data) { attach a; a.fvalue = data; return a; }
+	static inline attach to_attach(const char *data) {
+		attach a;
+		safeCopy(a.svalue, attach_string_size, data);
+		return a;
 	}
 
-	// increase_index macros.
-#define increase_index(index, step, max_size) {           \
-        (index) += (step);                                \
-        (index) %= (max_size);                            \
-    }
-
+	/// all kinds of macros start.
 	// timer id check.
 #define exist_timer_id_check(id, remove)                  \
     add_timer_ret ret = ADD_TIMER_FAIL;                   \
@@ -70,290 +109,630 @@ namespace STimeWheelSpace {
 	}                                                     \
 
 	// do add timer macro.for all add timer function.
-#define do_add_timer(func, id, delay, timerType, data, remove, release_func) { \
-      if (delay < 0) return ADD_TIMER_FAIL;                                 \
-                                                                            \
-      exist_timer_id_check((id), (remove));                                 \
-	  wheel_info *info = CTimeWheel::instance().set_timer(func, data, id, delay, timerType, this); \
-	  if (!info) return ADD_TIMER_FAIL;                                     \
-      if (info == &wheel_info_) return ADD_TIMER_SUCC;                      \
-      info->release = (release_func);                                       \
-	  m_timer[id]   = info;                                                 \
-      return ret;                                                           \
-    }
+#define do_add_timer(func, id, delay, timerType, data, remove, release_func) \
+	return this->_add_id_timer(std::move(func), id, delay, timerType, to_attach(data), remove, release_func, 0)
 	/// all kinds of macros end.
 
-	CTimeWheel::CTimeWheel() : m_array(nullptr), m_index(0), m_next_objId(0) {
-		assert(Max_array_size > 0 && "array size error");
-		m_array = new list_head[Max_array_size];
+	//
+	// wheel core.
+	//
+	// geometry check.
+	static bool valid_geometry(const wheel_geometry &geo) {
+		if (geo.tick_us == 0 || geo.levels == 0 || geo.levels > max_wheel_levels ||
+			geo.pool_grow == 0) {
+			return false;
+		}
+		for (uint32 level = 0; level < geo.levels; level++) {
+			if (geo.slots[level] == 0) return false;
+		}
+		return true;
+	}
+
+	CWheelCore::CWheelCore(const wheel_geometry &geo) : m_geo(geo), m_slot_count(0),
+		m_array(nullptr), m_tick(0), m_firing(nullptr), m_dispatcher(nullptr),
+		m_dispatched(0), m_done(nullptr), m_lag(0) {
+		assert(valid_geometry(geo) && "wheel geometry error");
+		if (!valid_geometry(geo)) {
+			m_geo = default_geometry;
+		}
+		memset(m_state_count, 0, sizeof(m_state_count));
+
+		// level offset and slot unit.
+		uint64 unit = 1;
+		for (uint32 level = 0; level < m_geo.levels; level++) {
+			m_offset[level] = m_slot_count;
+			m_unit[level] = unit;
+			m_slot_count += m_geo.slots[level];
+			unit *= m_geo.slots[level];
+		}
+
+#if TIME_WHEEL_SOA_SLOTS
+		m_array = new CSlotBucket<wheel_node>[m_slot_count];
 		assert(m_array && "new memory error");
+#else
+		m_array = new list_head[m_slot_count];
+		assert(m_array && "new memory error");
+#endif
 
 		// last time.
-		m_last_time = get_system_time();
+		m_last_time = get_system_time_us();
 
+#if !TIME_WHEEL_SOA_SLOTS
 		// construct head. 
-		for (uint32 i = 0; i < Max_array_size; i++) {
+		for (uint32 i = 0; i < m_slot_count; i++) {
 			INIT_LIST_HEAD(&m_array[i]);
 		}
+#endif
+		m_bitmap.init(m_slot_count);
+	}
 
-		bool r = m_pool.init(pool_start_size, pool_grow_size);
-		assert(r && "init error");
+	CWheelCore::~CWheelCore() {
+		// timers are released by typed wheel.
+		delete[] m_array;
+		m_array = nullptr;
 	}
 
-	CTimeWheel::~CTimeWheel() {
-		if (!m_array) return;
+	bool CWheelCore::_take_tick(uint64 end, list_head *expired) {
+		if ((m_tick = _next_tick(end)) >= end) {
+			return false;
+		}
+
+		// higher level slots cascade down at their boundary.
+		for (uint32 level = m_geo.levels - 1; level > 0; level--) {
+			if (m_tick % m_unit[level] == 0) {
+				this->_cascade(level);
+			}
+		}
+
+		// take all off, callback may cancel any of them.
+		uint32 index = uint32(m_tick % m_geo.slots[0]);
+		if (m_bitmap.test(index)) {
+			this->_take_slot(index, m_tick + 1, expired);
+		}
+		return true;
+	}
+
+	void CWheelCore::_take_all(list_head *all) {
+		for (uint32 i = 0; i < m_slot_count; i++) {
+#if TIME_WHEEL_SOA_SLOTS
+			m_array[i].take_all([all](wheel_node *pnode) {
+				pnode->slot_pos = 0;
+				list_add_tail(&pnode->link, all);
+			});
+#else
+			list_splice_tail_init(&m_array[i], all);
+#endif
+			m_bitmap.reset(i);
+		}
+	}
 
-		// clear.
-		list_head *pos, *n;
-		wheel_info *pinfo;
-		for (uint32 i = 0; i < Max_array_size; i++) {
-			list_head *list = &m_array[m_index];
+	void CWheelCore::_take_slot(uint32 index, uint64 limit, list_head *out) {
+		// only top level slot has timers of later laps.
+		bool top = index >= m_offset[m_geo.levels - 1];
+#if TIME_WHEEL_SOA_SLOTS
+		CSlotBucket<wheel_node> &bucket = m_array[index];
+		auto take = [out](wheel_node *pnode) {
+			pnode->slot_pos = 0;
+			list_add_tail(&pnode->link, out);
+		};
+		if (top) {
+			bucket.take_due(limit, take, [](wheel_node *pnode, uint32 pos) {
+				pnode->slot_pos = pos + 1;
+			});
+		} else {
+			bucket.take_all(take);
+		}
+		if (bucket.empty()) {
+			m_bitmap.reset(index);
+		}
+#else
+		list_head *list = &m_array[index];
+		if (top) {
+			list_head *pos, *n;
 			list_for_each_safe(pos, n, list) {
-				if ((pinfo = list_entry(pos, wheel_info, link))) {
-					this->_do_release(pinfo);
-				} else {
-					assert(false && "get value pointer error");
+				if (list_entry(pos, wheel_node, link)->expire < limit) {
+					list_move_tail(pos, out);
 				}
-				// delete it.
-				list_del_init(pos);
 			}
+		} else {
+			list_splice_tail_init(list, out);
+		}
+		if (list_empty(list)) {
+			m_bitmap.reset(index);
 		}
+#endif
+	}
 
-		// delete array.
-		delete[] m_array;
-		m_array = nullptr;
+	uint64 CWheelCore::_next_tick(uint64 end) const {
+		uint64 next = end;
+		for (uint32 level = 0; level < m_geo.levels && next > m_tick; level++) {
+			// first boundary tick(>= m_tick) of this level and its slot.
+			uint64 unit = m_unit[level];
+			uint64 first = (m_tick + unit - 1) / unit * unit;
+			uint32 slots = m_geo.slots[level];
+			uint32 from = uint32((first / unit) % slots);
+
+			// next non-empty slot from there, wrap around.
+			uint32 begin = m_offset[level];
+			uint32 found = m_bitmap.find_next(begin + from, begin + slots);
+			if (found == begin + slots) {
+				found = m_bitmap.find_next(begin, begin + from);
+				if (found == begin + from) continue;
+			}
+
+			uint32 step = (found - begin + slots - from) % slots;
+			uint64 tick = first + step * unit;
+			if (tick < next) {
+				next = tick;
+			}
+		}
+		return next;
 	}
 
-	CTimeWheel &CTimeWheel::instance() {
-		static CTimeWheel instance;
-		return instance;
+	void CWheelCore::_done(wheel_node *pnode) {
+		wheel_node *head = m_done.load(std::memory_order_relaxed);
+		do {
+			pnode->link.next = head ? &head->link : nullptr;
+		} while (!m_done.compare_exchange_weak(head, pnode,
+			std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	wheel_node* CWheelCore::_take_done() {
+		wheel_node *pnode = m_done.exchange(nullptr, std::memory_order_acquire);
+
+		// stack is in reverse done order.
+		wheel_node *list = nullptr;
+		while (pnode) {
+			wheel_node *pnext = pnode->link.next ? list_entry(pnode->link.next, wheel_node, link) : nullptr;
+			pnode->link.next = list ? &list->link : nullptr;
+			list = pnode;
+			pnode = pnext;
+		}
+		return list;
+	}
+
+	uint32 CWheelCore::_elapsed() {
+		// whole ticks only, the rest is left to next call.
+		int64 ticks = (get_system_time_us() - m_last_time) / m_geo.tick_us;
+		if (ticks <= 0) return 0;
+		m_last_time += ticks * m_geo.tick_us;
+		return uint32(ticks);
 	}
 
-	void CTimeWheel::_release(wheel_info *pinfo) {
-		if (!pinfo) return;
-		m_pool.release_obj(pinfo);
+	void CWheelCore::_add(wheel_node *pnode) {
+		if (!pnode) return;
+
+		// expire tick.
+		pnode->expire = m_tick + m_lag + to_ticks(pnode->delay);
+		this->_place(pnode);
 	}
 
-	void CTimeWheel::_do_release(wheel_info *pinfo) {
-		if (!pinfo) return;
+	void CWheelCore::_place(wheel_node *pnode) {
+		// the lowest level whose lap can hold the left ticks,
+		// or the top level which is checked again every lap.
+		uint64 left = pnode->expire - m_tick;
+		uint32 level = 0;
+		while (level < m_geo.levels - 1 && left >= m_unit[level] * m_geo.slots[level]) {
+			level++;
+		}
+
+		uint32 slot = uint32((pnode->expire / m_unit[level]) % m_geo.slots[level]);
+		pnode->index = m_offset[level] + slot;
+		assert(pnode->index < m_slot_count && "add_index error");
 
+		// add tail.
+#if TIME_WHEEL_SOA_SLOTS
+		pnode->slot_pos = m_array[pnode->index].push(pnode->expire, pnode) + 1;
+#else
+		list_add_tail(&pnode->link, &m_array[pnode->index]);
+#endif
+		m_bitmap.set(pnode->index);
+	}
+
+	void CWheelCore::_unlink(wheel_node *pnode) {
+#if TIME_WHEEL_SOA_SLOTS
+		// its slot bucket.
+		if (pnode->slot_pos) {
+			CSlotBucket<wheel_node> &bucket = m_array[pnode->index];
+			wheel_node *moved = bucket.remove(pnode->slot_pos - 1);
+			if (moved) {
+				moved->slot_pos = pnode->slot_pos;
+			}
+			pnode->slot_pos = 0;
+			if (bucket.empty()) {
+				m_bitmap.reset(pnode->index);
+			}
+			return;
+		}
+
+		// or a pending list.
+		list_del_init(&pnode->link);
+#else
+		// its slot or a pending list.
+		list_del_init(&pnode->link);
+		if (list_empty(&m_array[pnode->index])) {
+			m_bitmap.reset(pnode->index);
+		}
+#endif
+	}
+
+	void CWheelCore::_cascade(uint32 level) {
+		uint32 slot = uint32((m_tick / m_unit[level]) % m_geo.slots[level]);
+		uint32 index = m_offset[level] + slot;
+		if (!m_bitmap.test(index)) return;
+
+		// timers of this slot lap go down, top level timers of later laps stay.
+		list_head pending;
+		INIT_LIST_HEAD(&pending);
+		this->_take_slot(index, m_tick + m_unit[level], &pending);
+
+		wheel_node *pnode;
+		while (!list_empty(&pending)) {
+			pnode = list_entry(pending.next, wheel_node, link);
+			list_del_init(&pnode->link);
+			this->_place(pnode);
+		}
+	}
+
+	void CWheelCore::_set_state(wheel_node *pnode, timer_state state) {
+		m_state_count[pnode->state]--;
+		m_state_count[state]++;
+		pnode->state = state;
+	}
+
+	//
+	// type-erased wheel.
+	//
+	void wheel_info::on_state(const wheel_node *pnode, timer_state new_state) {
+		if (!reg) return;
+		if (pnode->state == timer_state_running) {
+			reg->m_running--;
+		} else if (new_state == timer_state_running) {
+			reg->m_running++;
+		}
+	}
+
+	void wheel_info::on_release(const wheel_node *pnode) {
 		// try to release user allocating data.
-		if (pinfo->data.pvalue && pinfo->release) {
-			(pinfo->release)(pinfo->data.pvalue);
-			pinfo->data.pvalue = nullptr;
+		if (data.pvalue && release) {
+			(release)(data.pvalue);
+			data.pvalue = nullptr;
 		}
 
 		// try to remove it from register
-		if (pinfo->reg && pinfo->state != timer_state_released) {
-			pinfo->reg->remove_timer(pinfo);
+		if (reg && pnode->state != timer_state_released) {
+			reg->remove_timer(this);
+			if (pnode->state == timer_state_running) {
+				reg->m_running--;
+			}
 		}
+	}
 
-		// release
-		this->_release(pinfo);
+	CTimeWheel::CTimeWheel(const wheel_geometry &geo, uint32 post_size) : CTimeWheelT(geo),
+		m_ticket(0), m_posted_reg(new Register(*this)), m_sleeping(false),
+		m_wakeup(false), m_stop(false), m_waker(nullptr) {
+		bool r = m_posted.init(post_size);
+		assert(r && "init error");
+		(void)r;
 	}
 
-	void CTimeWheel::update(uint32 delta) {
-		if (delta <= 0) return;
+	CTimeWheel::~CTimeWheel() {
+		// posted timers go before wheel.
+		m_posted_reg.reset();
 
-		list_head *pos, *n;
-		wheel_info *pinfo;
-		while (delta-- > 0) {
-			list_head *list = &m_array[m_index];
-			list_for_each_safe(pos, n, list) {
-				pinfo = list_entry(pos, wheel_info, link);
-				assert(pinfo != nullptr && "pinfo is null");
-
-				// killed or released outside.
-				if (removable(pinfo)) {
-					this->_do_release(pinfo);
-					list_del_init(pos);
-					continue;
+		// all dispatched tasks are done.
+		m_thread_pool.reset();
+	}
+
+	CTimeWheel &CTimeWheel::instance() {
+		static thread_local CTimeWheel instance;
+		return instance;
+	}
+
+	void CTimeWheel::run() {
+		// posted timers count from now, not from last run.
+		uint32 elapsed = this->_elapsed();
+		m_lag = elapsed;
+		this->run_posted();
+		m_lag = 0;
+		this->update(elapsed);
+	}
+
+	void CTimeWheel::run_until_idle() {
+		for (;;) {
+			this->run();
+
+			std::unique_lock<std::mutex> lock(m_wait_lock);
+			if (m_stop.load(std::memory_order_relaxed)) {
+				m_stop.store(false, std::memory_order_relaxed);
+				return;
+			}
+
+			// a poster sees m_sleeping, or we see its command.
+			m_sleeping.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!m_wakeup && m_posted.empty()) {
+				uint64 next = this->next_wake_tick();
+				if (next == no_expiry) {
+					m_sleeping.store(false, std::memory_order_relaxed);
+					return;
 				}
 
-				// only it is running state can be done.
-				if (pinfo->state == timer_state_running ||
-					pinfo->state == timer_state_interrupted) {
-					// can execute now.
-					if (--pinfo->turn < 0) {
-						if (pinfo->state == timer_state_running) {
-							pinfo->func(&pinfo->data);
-						}
-
-						// remove first.
-						list_del_init(pos);
-
-						// can addable now?
-						if (addable(pinfo)) {
-							this->_add(pinfo);
-						} else {
-							this->_do_release(pinfo);
-						}
-					}
+				std::chrono::steady_clock::time_point deadline{ std::chrono::microseconds(this->get_tick_time(next)) };
+				m_wait_cond.wait_until(lock, deadline, [this]() { return m_wakeup; });
+			}
+			m_wakeup = false;
+			m_sleeping.store(false, std::memory_order_relaxed);
+		}
+	}
+
+	void CTimeWheel::run_busy_poll() {
+		int64 coarse_res = get_coarse_res_us();
+		while (!m_stop.load(std::memory_order_relaxed)) {
+			this->run();
+
+			uint64 next = this->next_wake_tick();
+			int64 deadline = (next == no_expiry) ? std::numeric_limits<int64>::max() : this->get_tick_time(next);
+
+			// far away: coarse clock is a jiffy late at most, spin with backoff.
+			uint32 backoff = 1;
+			while (!m_stop.load(std::memory_order_relaxed) && m_posted.empty() &&
+				get_coarse_time_us() + coarse_res < deadline) {
+				for (uint32 i = 0; i < backoff; i++) {
+					cpu_relax();
 				}
+				if (backoff < max_spin_backoff) backoff <<= 1;
 			}
 
-			// increase to next index.
-			increase_index(m_index, 1, Max_array_size);
+			// near: precise clock.
+			while (!m_stop.load(std::memory_order_relaxed) && m_posted.empty() &&
+				get_system_time_us() < deadline) {
+				cpu_relax();
+			}
 		}
+		m_stop.store(false, std::memory_order_relaxed);
 	}
 
-	void CTimeWheel::run() {
-		auto now = get_system_time();
-		this->update(uint32(now - m_last_time));
-		m_last_time = now;
+	void CTimeWheel::stop_run() {
+		std::lock_guard<std::mutex> guard(m_wait_lock);
+		m_stop.store(true, std::memory_order_relaxed);
+		m_wakeup = true;
+		m_wait_cond.notify_one();
+	}
+
+	void CTimeWheel::_wake() {
+		CTimerWaker *waker = m_waker.load(std::memory_order_acquire);
+		if (waker) {
+			waker->wake();
+		}
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_sleeping.load(std::memory_order_relaxed)) {
+			std::lock_guard<std::mutex> guard(m_wait_lock);
+			m_wakeup = true;
+			m_wait_cond.notify_one();
+		}
 	}
 
-	void CTimeWheel::_add(wheel_info *pinfo) {
-		if (!pinfo) return;
+	void CTimeWheel::set_parallel(uint32 threads) {
+		// the old pool runs all its tasks before it goes.
+		this->set_dispatcher(nullptr);
+		m_thread_pool.reset();
+		if (threads > 0) {
+			m_thread_pool.reset(new CTimerThreadPool(threads));
+			this->set_dispatcher(m_thread_pool.get());
+		}
+	}
 
-		// next delay time.
-		int32 delay = int32(pinfo->delay);
+	uint32 CTimeWheel::run_posted() {
+		uint32 count = 0;
+		timer_command cmd;
+		while (m_posted.pop(cmd)) {
+			count++;
+			switch (cmd.type) {
+			case command_add_timer:
+				if (cmd.timerType == repeatedType) {
+					m_posted_reg->add_repeated_timer(std::move(cmd.func), cmd.ticket, cmd.delay, cmd.data);
+				} else {
+					m_posted_reg->add_once_timer(std::move(cmd.func), cmd.ticket, cmd.delay, cmd.data);
+				}
+				break;
+			case command_kill_timer:
+				m_posted_reg->kill_timer(cmd.ticket);
+				break;
+			case command_reset_timer:
+				m_posted_reg->reset_timer(cmd.ticket);
+				break;
+			default:
+				assert(false && "command type error");
+				break;
+			}
+		}
+		return count;
+	}
 
-		// turns
-		pinfo->turn = delay / Max_array_size;
+	uint64 CTimeWheel::post_once_timer(timer_func&& func, int32 delay, const attach& data) {
+		return this->_post_timer(std::move(func), delay, onceType, data);
+	}
 
-		// index
-		pinfo->index = delay % Max_array_size;
+	uint64 CTimeWheel::post_repeated_timer(timer_func&& func, int32 delay, const attach& data) {
+		return this->_post_timer(std::move(func), delay, repeatedType, data);
+	}
 
-		// index check.
-		increase_index(pinfo->index, m_index, Max_array_size);
-		assert(pinfo->index >= 0 && pinfo->index < Max_array_size && "add_index error");
+	bool CTimeWheel::post_kill_timer(uint64 ticket) {
+		return ticket != 0 && this->_post(command_kill_timer, ticket, timer_command());
+	}
 
-		// add tail.
-		list_add_tail(&pinfo->link, &m_array[pinfo->index]);
+	bool CTimeWheel::post_reset_timer(uint64 ticket) {
+		return ticket != 0 && this->_post(command_reset_timer, ticket, timer_command());
 	}
 
-	wheel_info* CTimeWheel::_init_wheel_info(const timer_func& func, uint64 id,
-		int32 delay, eTimerType timerType, Register *reg
+	uint64 CTimeWheel::_post_timer(timer_func&& func, int32 delay,
+		eTimerType timerType, const attach& data
 	) {
-		wheel_info *pInfo = m_pool.fetch_obj();
-		assert(pInfo && "alloc wheel_info error");
-		if (!pInfo) return nullptr;
-
-		pInfo->id = id;
-		pInfo->func = std::move(func);
-		pInfo->delay = delay;
-		pInfo->timerType = timerType;
-		pInfo->state = timer_state_running;
-		pInfo->reg = reg;
-		pInfo->release = nullptr;
-		pInfo->start_time = get_system_time();
-		pInfo->objId = m_next_objId++;
-		return pInfo;
-	}
-
-	uint32 CTimeWheel::get_all_timer() const {
-		uint32 count = 0;
-		for (uint32 i = 0; i < Max_array_size; i++) {
-			list_head *pos, *n;
-			list_head *list = &m_array[i];
-			list_for_each_safe(pos, n, list) {
-				count++;
+		if (delay < 0 || (delay == 0 && timerType == repeatedType)) {
+			return 0;
+		}
+
+		// invalid_timer_id can not be a register id.
+		uint64 ticket = m_ticket.fetch_add(1, std::memory_order_relaxed) + 1;
+		if (ticket == invalid_timer_id) {
+			ticket = m_ticket.fetch_add(1, std::memory_order_relaxed) + 1;
+		}
+
+		timer_command cmd;
+		cmd.timerType = uint8(timerType);
+		cmd.delay = delay;
+		cmd.func = std::move(func);
+		cmd.data = data;
+		if (!this->_post(command_add_timer, ticket, std::move(cmd))) {
+			// full: give func back, so caller can post it again.
+			func = std::move(cmd.func);
+			return 0;
+		}
+		return ticket;
+	}
+
+	bool CTimeWheel::_post(uint8 type, uint64 ticket, timer_command &&cmd) {
+		cmd.type = type;
+		cmd.ticket = ticket;
+		if (!m_posted.push(std::move(cmd))) {
+			return false;
+		}
+		this->_wake();
+		return true;
+	}
+
+	uint32 CTimeWheel::add_timers(timer_spec *specs, uint32 count, timer_handle *results) {
+		if (!specs || count == 0) return 0;
+
+		this->reserve_timer(count);
+		int64 now = get_system_time();
+		uint32 added = 0;
+		for (uint32 i = 0; i < count; i++) {
+			timer_spec &spec = specs[i];
+			timer_handle handle = invalid_timer_handle;
+			if (spec.delay >= 0) {
+				handle = this->set_timer(std::move(spec.func), spec.data, spec.id, spec.delay,
+					spec.timerType, nullptr, now);
 			}
+			if (handle) added++;
+			if (results) results[i] = handle;
 		}
-		return count;
+		return added;
 	}
 
-	bool CTimeWheel::add_once_timer(const timer_func& func, int32 delay, const attach& data) {
-		return nullptr != set_timer(func, data, 0, delay, onceType);
+	uint32 CTimeWheel::kill_timers(const timer_handle *handles, uint32 count, bool *results) {
+		uint32 killed = 0;
+		for (uint32 i = 0; handles && i < count; i++) {
+			bool r = this->kill_timer(handles[i]);
+			if (r) killed++;
+			if (results) results[i] = r;
+		}
+		return killed;
 	}
 
-	bool CTimeWheel::add_repeated_timer(const timer_func& func, int32 delay, const attach& data) {
-		return nullptr != set_timer(func, data, 0, delay, repeatedType);
+	timer_handle CTimeWheel::add_class_timer(uint32 cls, uint64 id, int32 delay,
+		const attach& data, eTimerType timerType
+	) {
+		timer_handle handle = CTimeWheelT::add_class_timer(cls, delay, data, timerType);
+		wheel_info *pinfo = this->find_entry(handle);
+		if (pinfo) {
+			pinfo->node = this->find_timer(handle);
+			pinfo->id = id;
+			pinfo->start_time = get_system_time();
+		}
+		return handle;
 	}
 
-	bool CTimeWheel::add_timer_at(const timer_func &func, int64 timestamp,
+	timer_handle CTimeWheel::add_timer_at(timer_func &&func, int64 timestamp,
 		const attach& data /*= attach_ */
 	) {
 		auto now = get_system_time();
 		int32 delay = int32(timestamp - now);
-		return add_once_timer(func, delay, data);
+		return add_once_timer(std::move(func), delay, data);
 	}
 
-	wheel_info* CTimeWheel::set_timer(const timer_func& func, void* data,
+	timer_handle CTimeWheel::set_timer(timer_func&& func, void* data,
 		uint64 id, int32 delay, eTimerType timerType, Register *reg
 	) {
 		attach a;a.pvalue = data;
-		return set_timer(func, a, id, delay, timerType, reg);
+		return set_timer(std::move(func), a, id, delay, timerType, reg);
 	}
 
-	wheel_info* CTimeWheel::set_timer(const timer_func& func, int64 data,
+	timer_handle CTimeWheel::set_timer(timer_func&& func, int64 data,
 		uint64 id, int32 delay, eTimerType timerType, Register *reg
 	) {
 		attach a;a.ivalue = data;
-		return set_timer(func, a, id, delay, timerType, reg);
+		return set_timer(std::move(func), a, id, delay, timerType, reg);
 	}
 
-	wheel_info* CTimeWheel::set_timer(const timer_func& func, const char* data,
+	timer_handle CTimeWheel::set_timer(timer_func&& func, const char* data,
 		uint64 id, int32 delay, eTimerType timerType, Register *reg
 	) {
 		attach a;
 		safeCopy(a.svalue, attach_string_size, data);
-		return set_timer(func, a, id, delay, timerType, reg);
+		return set_timer(std::move(func), a, id, delay, timerType, reg);
 	}
 
-	wheel_info* CTimeWheel::set_timer(const timer_func& func, uint64 data,
+	timer_handle CTimeWheel::set_timer(timer_func&& func, uint64 data,
 		uint64 id, int32 delay, eTimerType timerType, Register *reg
 	) {
 		attach a;a.uvalue = data;
-		return set_timer(func, a, id, delay, timerType, reg);
+		return set_timer(std::move(func), a, id, delay, timerType, reg);
 	}
 
-	wheel_info* CTimeWheel::set_timer(const timer_func& func, decimal data,
+	timer_handle CTimeWheel::set_timer(timer_func&& func, decimal data,
 		uint64 id, int32 delay, eTimerType timerType, Register *reg
 	) {
 		attach a;a.fvalue = data;
-		return set_timer(func, a, id, delay, timerType, reg);
+		return set_timer(std::move(func), a, id, delay, timerType, reg);
 	}
 
-	wheel_info* CTimeWheel::set_timer(const timer_func& func, const attach& data,
-		uint64 id, int32 delay, eTimerType timerType, Register *reg
+	timer_handle CTimeWheel::set_timer(timer_func&& func, const attach& data,
+		uint64 id, int32 delay, eTimerType timerType, Register *reg, int64 start_time
 	) {
-		check_timer_para(delay, timerType);
-		if (delay <= 0) { // if delay <= 0, then just call it right now.
-			attach a = data;
-			// execute it right now.
-			func(&a);
-			// return special object.
-			return &wheel_info_;
-		}
-
-		wheel_info *pinfo = _init_wheel_info(func, id, delay, timerType, reg);
-		if (&data != &attach_) { // init attach exclude default attach_
-			pinfo->data = data;
-		} else {
-			pinfo->data.pvalue = nullptr;
+		timer_handle handle = this->_set_timer(std::move(func), data, delay, timerType);
+		wheel_info *pinfo = this->find_entry(handle);
+		if (pinfo) {
+			pinfo->node = this->find_timer(handle);
+			pinfo->id = id;
+			pinfo->reg = reg;
+			pinfo->start_time = start_time ? start_time : get_system_time();
+			if (reg) {
+				reg->m_running++;
+			}
 		}
-		this->_add(pinfo);
-		return pinfo;
+		return handle;
 	}
 
 	//
 	// timer register.
 	//
-	CTimerRegister::CTimerRegister() {
+	CTimerRegister::CTimerRegister(CTimeWheel &wheel) : m_wheel(wheel), m_next_id(1), m_running(0) {
 		m_timer.clear();
+		INIT_LIST_HEAD(&m_chain);
 	}
 
 	CTimerRegister::~CTimerRegister() {
 		this->_release_all_timer();
 	}
 
-	add_timer_ret CTimerRegister::add_repeated_timer(const timer_func&& func,
+	add_timer_ret CTimerRegister::add_repeated_timer(timer_func&& func,
 		uint64 id, int32 delay, const attach &data, bool remove,
 		void(*release_func)(void*)
 	) {
 		do_add_timer(func, id, delay, repeatedType, data, remove, release_func);
 	}
 
-	add_timer_ret CTimerRegister::add_once_timer(const timer_func&& func,
+	add_timer_ret CTimerRegister::add_once_timer(timer_func&& func,
 		uint64 id, int32 delay, const attach &data, bool remove,
 		void(*release_func)(void*)
 	) {
 		do_add_timer(func, id, delay, onceType, data, remove, release_func);
 	}
 
-	add_timer_ret CTimerRegister::add_timer_at(const timer_func&& func,
+	add_timer_ret CTimerRegister::add_timer_at(timer_func&& func,
 		uint64 id, int64 timestamp, const attach &data, bool remove,
 		void(*release_func)(void*)
 	) {
@@ -366,12 +745,87 @@ namespace STimeWheelSpace {
 		}
 	}
 
+	timer_handle CTimerRegister::add_repeated_timer(timer_func&& func,
+		int32 delay, const attach &data, void(*release_func)(void*)
+	) {
+		return _add_handle_timer(std::move(func), delay, repeatedType, data, release_func);
+	}
+
+	timer_handle CTimerRegister::add_once_timer(timer_func&& func,
+		int32 delay, const attach &data, void(*release_func)(void*)
+	) {
+		return _add_handle_timer(std::move(func), delay, onceType, data, release_func);
+	}
+
+	uint32 CTimerRegister::add_timers(timer_spec *specs, uint32 count, add_timer_ret *results,
+		bool remove, void(*release_func)(void*)
+	) {
+		if (!specs || count == 0) return 0;
+
+		m_wheel.reserve_timer(count);
+		m_timer.reserve(m_timer.size() + count);
+		int64 now = get_system_time();
+		uint32 added = 0;
+		for (uint32 i = 0; i < count; i++) {
+			timer_spec &spec = specs[i];
+			add_timer_ret ret = this->_add_id_timer(std::move(spec.func), spec.id, spec.delay,
+				spec.timerType, spec.data, remove, release_func, now);
+			if (ret != ADD_TIMER_FAIL && ret != EXIST_NOT_REMOVE_RET) added++;
+			if (results) results[i] = ret;
+		}
+		return added;
+	}
+
+	uint32 CTimerRegister::kill_timers(const uint64 *ids, uint32 count, bool *results) {
+		uint32 killed = 0;
+		for (uint32 i = 0; ids && i < count; i++) {
+			bool r = this->kill_timer(ids[i]);
+			if (r) killed++;
+			if (results) results[i] = r;
+		}
+		return killed;
+	}
+
+	add_timer_ret CTimerRegister::_add_id_timer(timer_func&& func, uint64 id, int32 delay,
+		eTimerType timerType, const attach &data, bool remove, void(*release_func)(void*), int64 start_time
+	) {
+		if (delay < 0) return ADD_TIMER_FAIL;
+
+		exist_timer_id_check(id, remove);
+		timer_handle handle = m_wheel.set_timer(std::move(func), data, id, delay, timerType, this, start_time);
+		if (!handle) return ADD_TIMER_FAIL;
+		wheel_info *info = m_wheel.find_entry(handle);
+		if (!info) return ADD_TIMER_SUCC; // called right now.
+		info->release = release_func;
+		m_timer[id] = info;
+		list_add_tail(&info->reg_link.link, &m_chain);
+		if (id >= m_next_id) m_next_id = id + 1;
+		if (m_next_id == invalid_timer_id) m_next_id++;
+		return ret;
+	}
+
+	timer_handle CTimerRegister::_add_handle_timer(timer_func&& func, int32 delay,
+		eTimerType timerType, const attach &data, void(*release_func)(void*)
+	) {
+		if (delay < 0) return invalid_timer_handle;
+
+		timer_handle handle = m_wheel.set_timer(std::move(func), data, invalid_timer_id, delay, timerType, this);
+		wheel_info *info = m_wheel.find_entry(handle);
+		if (info) {
+			info->release = release_func;
+			list_add_tail(&info->reg_link.link, &m_chain);
+		}
+		return handle;
+	}
+
 	add_timer_ret CTimerRegister::_repeat_timer_check(bool replace, uint64 id) {
 		auto it = m_timer.find(id);
 		if (it != m_timer.end()) {
-			if (it->second->state != timer_state_killed) { // not killed.
+			if (it->second->node->state != timer_state_killed) { // not killed.
 				if (replace) {// new state, other state will be down.
-					it->second->state = timer_state_replaced;
+					wheel_node *pnode = it->second->node;
+					m_wheel.set_state(pnode, timer_state_replaced);
+					m_wheel.cancel_timer(pnode);
 					return EXIST_REMOVE_RET;
 				} else {
 					return EXIST_NOT_REMOVE_RET;
@@ -381,20 +835,9 @@ namespace STimeWheelSpace {
 		return ADD_TIMER_SUCC;
 	}
 
-	uint64 CTimerRegister::next_id() const {
-		uint64 maxId = 0;
-		auto it = m_timer.begin();
-		for (; it != m_timer.end(); it++) {
-			if (it->first > maxId) {
-				maxId = it->first;
-			}
-		}
-		return maxId + 1;
-	}
-
 	void CTimerRegister::_out_put_timer(const wheel_info *timer) {
 		printf("objId:%d,id:%lld, left time:%d",
-			timer->objId, timer->id,
+			timer->node->objId, timer->id,
 			int(get_left_time(timer->id))
 		);
 	}
@@ -405,35 +848,35 @@ namespace STimeWheelSpace {
 		}
 	}
 
-	add_timer_ret CTimerRegister::add_timer(const timer_func&& func,
+	add_timer_ret CTimerRegister::add_timer(timer_func&& func,
 		void *pData, uint64 id, int32 expire, bool loop, bool remove,
 		void(*release_func)(void*)
 	) {
 		do_add_timer(func, id, expire, loop ? repeatedType : onceType, pData, remove, release_func);
 	}
 
-	add_timer_ret CTimerRegister::add_timer(const timer_func&& func,
+	add_timer_ret CTimerRegister::add_timer(timer_func&& func,
 		int64 ivalue, uint64 id, int32 expire, bool loop, bool remove,
 		void(*release_func)(void*)
 	) {
 		do_add_timer(func, id, expire, loop ? repeatedType : onceType, ivalue, remove, release_func);
 	}
 
-	add_timer_ret CTimerRegister::add_timer(const timer_func&& func,
+	add_timer_ret CTimerRegister::add_timer(timer_func&& func,
 		const char svalue[], uint64 id, int32 expire, bool loop,
 		bool remove, void(*release_func)(void*)
 	) {
 		do_add_timer(func, id, expire, loop ? repeatedType : onceType, svalue, remove, release_func);
 	}
 
-	add_timer_ret CTimerRegister::add_timer(const timer_func&& func,
+	add_timer_ret CTimerRegister::add_timer(timer_func&& func,
 		uint64 data, uint64 id, int32 expire, bool loop, bool remove,
 		void(*release_func)(void*)
 	) {
 		do_add_timer(func, id, expire, loop ? repeatedType : onceType, data, remove, release_func);
 	}
 
-	add_timer_ret CTimerRegister::add_timer(const timer_func&& func,
+	add_timer_ret CTimerRegister::add_timer(timer_func&& func,
 		decimal data, uint64 id, int32 expire, bool loop,
 		bool remove, void(*release_func)(void*)
 	) {
@@ -441,31 +884,39 @@ namespace STimeWheelSpace {
 	}
 
 	bool CTimerRegister::kill_timer(uint64 id) {
-		if (this->_set_state(id, timer_state_killed)) {
-			this->m_timer.erase(id);
-			return true;
-		} else {
+		auto it = m_timer.find(id);
+		if (it == m_timer.end()) {
 			return false;
 		}
+
+		// free it right now.
+		wheel_node *pnode = it->second->node;
+		m_timer.erase(it);
+		m_wheel.set_state(pnode, timer_state_killed);
+		m_wheel.cancel_timer(pnode);
+		return true;
 	}
 
 	void CTimerRegister::kill_all_timer() {
-		for (auto &e : m_timer) {
-			e.second->state = timer_state_killed;
-			e.second->reg = nullptr;
-		}
 		m_timer.clear();
+		this->_free_all_timer(timer_state_killed);
 	}
 
 	void CTimerRegister::_release_all_timer() {
-		for (auto &e : m_timer) {
-			e.second->state = timer_state_released;
-			if (e.second->reg != nullptr) {
-				assert(e.second->reg == this && "reg is not the same");
-			}
-			e.second->reg = nullptr;
+		// map goes with me, only the chain is walked.
+		this->_free_all_timer(timer_state_released);
+	}
+
+	void CTimerRegister::_free_all_timer(timer_state state) {
+		wheel_info *info;
+		while (!list_empty(&m_chain)) {
+			info = list_entry(m_chain.next, wheel_info::reg_hook, link)->owner;
+			assert(info->reg == this && "reg is not the same");
+			list_del_init(&info->reg_link.link);
+			m_wheel.set_state(info->node, state);
+			info->reg = nullptr;
+			m_wheel.cancel_timer(info->node);
 		}
-		m_timer.clear();
 	}
 
 	int64 CTimerRegister::get_left_time(uint64 id) const {
@@ -479,23 +930,11 @@ namespace STimeWheelSpace {
 			return -1;
 		}
 
-		if (pinfo->state != timer_state_running) {
+		if (pinfo->node->state != timer_state_running) {
 			return -1;
 		}
 
-		uint32 index = CTimeWheel::instance().get_index();
-		int64 left_time = 0;
-		if (index <= pinfo->index) {
-			left_time = pinfo->index - index;
-		} else {
-			left_time = Max_array_size - (index - pinfo->index);
-		}
-
-		int64 turns = int64(pinfo->turn - 1);
-		if (turns >= 0) {
-			left_time += turns * int64(Max_array_size);
-		}
-		return left_time;
+		return m_wheel.get_left_time(pinfo->node);
 	}
 
 	wheel_info* CTimerRegister::find_timer(uint64 id) {
@@ -519,13 +958,13 @@ namespace STimeWheelSpace {
 	// must have id timer and proper state.
 	bool CTimerRegister::has_timer(uint64 id) const {
 		const wheel_info *wheel = this->find_timer(id);
-		return wheel && wheel->state == timer_state_running;
+		return wheel && wheel->node->state == timer_state_running;
 	}
 
 	bool CTimerRegister::_set_state(uint64 id, timer_state state) {
 		auto it = m_timer.find(id);
 		if (it != m_timer.end()) {
-			it->second->state = state;
+			m_wheel.set_state(it->second->node, state);
 			return true;
 		} else {
 			return false;
@@ -535,24 +974,20 @@ namespace STimeWheelSpace {
 	void CTimerRegister::remove_timer(wheel_info *info) {
 		if (info == nullptr) return;
 
+		// handle timer is not in map.
+		list_del_init(&info->reg_link.link);
+		if (info->id == invalid_timer_id) {
+			return;
+		}
+
 		auto it = m_timer.find(info->id);
 		if (it != m_timer.end()) {
-			if (it->second->objId == info->objId) {
+			if (it->second == info) {
 				m_timer.erase(info->id);
 			}
 		}
 	}
 
-	uint32 CTimerRegister::get_timer_count() const {
-		uint32 count = 0;
-		for (const auto &e : m_timer) {
-			if (this->has_timer(e.first)) {
-				count++;
-			}
-		}
-		return count;
-	}
-
 	const attach* CTimerRegister::get_timer_attach(uint64 id) {
 		auto timerInfo = this->find_timer(id);
 		if (!timerInfo) {
@@ -570,4 +1005,37 @@ namespace STimeWheelSpace {
 		return this->_set_state(id, timer_state_running);
 	}
 
-}
\ No newline at end of file
+	bool CTimerRegister::reset_timer(uint64 id) {
+		auto it = m_timer.find(id);
+		return it != m_timer.end() && m_wheel.reset_timer(it->second->node);
+	}
+
+	wheel_info* CTimerRegister::find_timer(const timer_handle &handle) const {
+		wheel_info *info = m_wheel.find_entry(handle);
+		return (info && info->reg == this) ? info : nullptr;
+	}
+
+	bool CTimerRegister::kill_timer(const timer_handle &handle) {
+		return this->find_timer(handle) && m_wheel.kill_timer(handle);
+	}
+
+	bool CTimerRegister::interrupt(const timer_handle &handle) {
+		return this->find_timer(handle) && m_wheel.interrupt(handle);
+	}
+
+	bool CTimerRegister::reStart(const timer_handle &handle) {
+		return this->find_timer(handle) && m_wheel.reStart(handle);
+	}
+
+	bool CTimerRegister::reset_timer(const timer_handle &handle) {
+		return this->find_timer(handle) && m_wheel.reset_timer(handle);
+	}
+
+	bool CTimerRegister::has_timer(const timer_handle &handle) const {
+		return this->find_timer(handle) && m_wheel.has_timer(handle);
+	}
+
+	int64 CTimerRegister::get_left_time(const timer_handle &handle) const {
+		return this->find_timer(handle) ? m_wheel.get_left_time(handle) : -1;
+	}
+}
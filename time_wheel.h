@@ -2,6 +2,8 @@
 // note  : new timer for 1ms unit.
 // author: gavingqf@126.com, 2019/9/6
 // idea  : limited array for unlimited time.
+//         hierarchical levels(ms, s, min, hour by default, tick and slots can be set per wheel),
+//         timer cascades down to lower level on rollover.
 // using high efficient double list, now it can support 1500w timers at the same time.
 
 // Copyright (c) 2019 - 2020 gavingqf (gavingqf@126.com)
@@ -26,17 +28,43 @@
 
 #pragma once
 
-#include <functional>
-#include <map>
 #include <utility>
 #include <memory>
 #include <tuple>
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <assert.h>
 #include "list.h"
-#include "../pool/objpool.h"
+#include "inline_func.h"
+#include "slot_bitmap.h"
+#include "slot_bucket.h"
+#include "node_pool.h"
+#include "flat_map.h"
+#include "mpsc_queue.h"
+
+// slot storage: 0 is intrusive list of nodes, 1 is array bucket of expire ticks and nodes.
+#ifndef TIME_WHEEL_SOA_SLOTS
+#define TIME_WHEEL_SOA_SLOTS 0
+#endif
+
+// c++20 coroutine awaitables(timer_coro.h).
+#ifndef TIMER_HAS_COROUTINE
+#if (__cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define TIMER_HAS_COROUTINE 1
+#endif
+#endif
+#endif
+#ifndef TIMER_HAS_COROUTINE
+#define TIMER_HAS_COROUTINE 0
+#endif
 
 namespace STimeWheelSpace {
 	// == typedef start, !!void* is attach* object.
-	typedef std::function<void(void*)> timer_func;
+	typedef CInlineFunc<void(void*), TIMER_FUNC_INLINE_SIZE> timer_func;
 	typedef unsigned int               uint32;
 	typedef int                        int32;
 	typedef unsigned short             uint16;
@@ -68,6 +96,7 @@ namespace STimeWheelSpace {
 	typedef uint64 timerIdType;
 
 	class CTimerRegister;
+	class CTimerSleep;
 
 	// Add timer return value.
 	typedef enum {
@@ -90,16 +119,31 @@ namespace STimeWheelSpace {
 	} max_digital_value;
 
 	// == const variable basic start
-	// timer array size.
-	static constexpr uint32 Max_array_size = (1 * 60 * 1000 - 1);
+	// max wheel levels.
+	static constexpr uint32 max_wheel_levels = 8;
 
 	// pool init size parameter.
 	static constexpr uint32 pool_start_size = 32;
 	static constexpr uint32 pool_grow_size = 8;
 
+	// max timer class count of a wheel.
+	static constexpr uint32 max_timer_classes = 255;
+
+	// cache line size, hot timer node is one line.
+	static constexpr uint32 cache_line_size = 64;
+
+	// max cpu pause count of a busy-poll round.
+	static constexpr uint32 max_spin_backoff = 64;
+
+	// posted command queue size of a wheel.
+	static constexpr uint32 post_queue_size = 1024;
+
 	// attach string size for attach.svalue.
 	static constexpr uint32 attach_string_size = uint32(sizeof(max_digital_value) + 1);
 
+	// no expiry tick: wheel is empty.
+	static constexpr uint64 no_expiry = ~uint64(0);
+
 	// invalid timer id definition: must use it carefully.
 	static constexpr uint32 invalid_timer_id = uint32(~0);
 	// == const variable basic end
@@ -117,6 +161,35 @@ namespace STimeWheelSpace {
 
 	typedef CTimerRegister Register;
 
+	// wheel geometry, chosen per wheel at construction.
+	// a slot of level n is as long as a lap of level n - 1, timer longer than
+	// the top level lap stays at top level and it is re-placed once a lap.
+	typedef struct wheel_geometry {
+		uint32 tick_us;                    // tick length: us.
+		uint32 levels;                     // level count, 1 ~ max_wheel_levels.
+		uint32 slots[max_wheel_levels];    // slot count of every level.
+		uint32 pool_start;                 // pool init size.
+		uint32 pool_grow;                  // first pool slab size, later slabs double.
+	} wheel_geometry;
+
+	// default geometry: 1ms tick, ms, second, minute and hour level.
+	static constexpr wheel_geometry default_geometry = {
+		1000, 4, { 1000, 60, 60, 24 }, pool_start_size, pool_grow_size
+	};
+
+	// timer handle: pool index(objId) and its generation, it is invalid after timer released.
+	typedef struct timer_handle {
+		uint32 index;                      // objId of timer.
+		uint32 gen;                        // generation of objId, 0 is invalid.
+		explicit operator bool() const { return gen != 0; }
+	} timer_handle;
+
+	// invalid handle, add timer fail.
+	static constexpr timer_handle invalid_timer_handle = { 0, 0 };
+
+	// handle of timer which is called right now(delay is 0), it can not be found.
+	static constexpr timer_handle fired_timer_handle = { uint32(~0), uint32(~0) };
+
 	// attach data.
 	// integer(sign and unsign, also can for boolean), pointer, string and double attach.
 	typedef union {
@@ -147,160 +220,950 @@ namespace STimeWheelSpace {
 #define to_pointer(p)   ((void*)(p))
 #endif
 
-	// Time wheel info
-	typedef struct {
-		uint64            id;          // timer id(it is not a unique id)
-		int32             turn;        // must signed.
+	// hot part of every timer node, it is all the wheel needs to move a timer,
+	// it is one cache line, and callback, payload and others are at cold entry.
+	typedef struct alignas(cache_line_size) wheel_node {
+		uint64            expire;      // expire tick.
 		uint32            delay;       // timer time: ms, if delay == 0, then execute timer right now.
-		timer_func        func;        // callback lambda
-		attach            data;        // attach.
-		void(*release)(void*);         // data release func.
-		eTimerType        timerType;   // as eTimerType.
+		uint32            index;       // index of array(all levels).
+		uint32            objId;       // timer object id, it is pool index(unique among living timers).
+		uint8             timerType;   // as eTimerType.
 		uint8             state;       // state, as timer_state
-		Register          *reg;        // register pointer.
-		uint32            index;       // index of array.
+		uint8             dispatched;  // callback is being run at dispatcher.
+		uint8             batch;       // timer class, 0 is none.
 		list_head         link;        // list head to form a double queue.
-		int64             start_time;  // timer start time.
-		uint32            objId;       // timer object id, it is an unique object id.
-	} wheel_info;
-	inline bool addable(wheel_info *info) {   // must add to queue.
+#if TIME_WHEEL_SOA_SLOTS
+		uint32            slot_pos;    // position + 1 in slot bucket, 0 is not in any.
+#endif
+	} wheel_node;
+	static_assert(sizeof(wheel_node) == cache_line_size, "wheel node is not one cache line");
+	inline bool addable(const wheel_node *info) {   // must add to queue.
 		return (repeatedType == info->timerType && timer_state_running == info->state)
 			|| timer_state_interrupted == info->state;
 	}
-	inline bool removable(wheel_info *info) { // must remove from queue.
+	inline bool removable(const wheel_node *info) { // must remove from queue.
 		return !(timer_state_running == info->state ||
 			timer_state_interrupted == info->state);
 	}
-	static wheel_info wheel_info_;     // global wheel info.
 
-	// time wheel timer class.
-	class CTimeWheel final {
+	// expired callback task of parallel dispatch mode.
+	typedef CInlineFunc<void(), 3 * sizeof(void*)> dispatch_task;
+
+	// dispatcher of parallel dispatch mode: it runs expired callbacks at other threads,
+	// so tick latency of wheel thread is bounded by bookkeeping, not by user code.
+	class CTimerDispatcher {
+	public:
+		virtual ~CTimerDispatcher() {}
+
+		// run expired tasks of a tick, every task must be moved out and called once.
+		virtual void dispatch(dispatch_task *tasks, uint32 count) = 0;
+	};
+
+	// waker of a wheel which sleeps at an outside loop(as epoll),
+	// it is called at posting thread after a command is posted.
+	class CTimerWaker {
+	public:
+		virtual ~CTimerWaker() {}
+
+		// wheel has posted commands, make its thread run it.
+		virtual void wake() = 0;
+	};
+
+	// wheel core: levels, slots, bitmap and counters, it knows nothing about callback and payload.
+	class CWheelCore {
 	protected:
-		CTimeWheel();
-		virtual ~CTimeWheel();
+		CWheelCore(const wheel_geometry &geo);
+		~CWheelCore();
 		// can not copyable class.
-		const CTimeWheel& operator=(const CTimeWheel& rhs) = delete;
-		CTimeWheel(const CTimeWheel& rhs) = delete;
-		typedef SObjPoolSpace::object_pool<wheel_info, true> wheel_pool;
+		const CWheelCore& operator=(const CWheelCore& rhs) = delete;
+		CWheelCore(const CWheelCore& rhs) = delete;
 
 	public:
-		static CTimeWheel &instance();
+		// current index of lowest level.
+		uint32            get_index() const { return uint32(m_tick % m_geo.slots[0]); }
+
+		// current tick.
+		uint64            get_tick() const { return m_tick; }
+
+		// wheel geometry.
+		const wheel_geometry& get_geometry() const { return m_geo; }
+
+		// ms to ticks(round up, at least 1 tick).
+		uint64            to_ticks(uint32 ms) const {
+			uint64 ticks = (uint64(ms) * 1000 + m_geo.tick_us - 1) / m_geo.tick_us;
+			return ticks > 0 ? ticks : 1;
+		}
+
+		// left time of timer node: ms, 0 if its callback is being run(expire is passed).
+		int64             get_left_time(const wheel_node *pnode) const {
+			if (pnode->dispatched || pnode->expire <= m_tick) return 0;
+			return int64((pnode->expire - m_tick) * m_geo.tick_us / 1000);
+		}
+
+		// earliest tick which has work to do(an expiry, or cascade of a higher level slot),
+		// no_expiry if wheel is empty, O(levels).
+		uint64            next_expiry() const { return this->_next_tick(no_expiry); }
+
+		// tick which a sleeping loop wakes up at: dispatched timer is finished at next run,
+		// so it is current tick while any is dispatched, or next expiry.
+		uint64            next_wake_tick() const { return m_dispatched > 0 ? m_tick : this->next_expiry(); }
+
+		// steady clock time(us) when run() handles tick(tick >= current tick).
+		int64             get_tick_time(uint64 tick) const {
+			return m_last_time + int64(tick - m_tick + 1) * m_geo.tick_us;
+		}
+
+		// running timer count.
+		uint32            get_running_timer() const { return m_state_count[timer_state_running]; }
+
+		// interrupted timer count.
+		uint32            get_interrupted_timer() const { return m_state_count[timer_state_interrupted]; }
+
+		// killed(replaced or released) timer count which is waiting to be released.
+		uint32            get_killed_timer() const {
+			return m_state_count[timer_state_killed] + m_state_count[timer_state_replaced]
+				+ m_state_count[timer_state_released];
+		}
+
+		// parallel dispatch mode: expired callbacks of a tick are handed to dispatcher,
+		// and repeated timer is added again after its callback completes.
+		// callbacks must not touch the wheel then(use post functions).
+		// nullptr is the default inline mode, dispatcher must live longer than its tasks.
+		void              set_dispatcher(CTimerDispatcher *dispatcher) { m_dispatcher = dispatcher; }
+		CTimerDispatcher* get_dispatcher() const { return m_dispatcher; }
+
+		// timer count whose callback is being run at dispatcher.
+		uint32            get_dispatched_timer() const { return m_dispatched; }
+
+	protected:
+		// add timer node after its delay.
+		void              _add(wheel_node *pnode);
+
+		// put timer node to its level slot as its expire tick.
+		void              _place(wheel_node *pnode);
+
+		// unlink timer node from its slot(or any list it is in).
+		void              _unlink(wheel_node *pnode);
+
+		// move level slot timers down to lower level.
+		void              _cascade(uint32 level);
+
+		// take timers of slot whose expire < limit(all of them if it is not top level).
+		void              _take_slot(uint32 index, uint64 limit, list_head *out);
+
+		// next tick(< end) which has any slot to do, or end if there is none.
+		uint64            _next_tick(uint64 end) const;
+
+		// go to next tick(< end) which has any slot to do, cascade and take its expired timers,
+		// return false if there is none and current tick is end.
+		bool              _take_tick(uint64 end, list_head *expired);
+
+		// take all timers off wheel.
+		void              _take_all(list_head *all);
+
+		// new timer node counter.
+		void              _count_new(wheel_node *pnode) { m_state_count[pnode->state]++; }
+
+		// released timer node counter.
+		void              _count_free(wheel_node *pnode) { m_state_count[pnode->state]--; }
+
+		// change state and counters.
+		void              _set_state(wheel_node *pnode, timer_state state);
+
+		// elapsed ticks from last call.
+		uint32            _elapsed();
+
+
+		// callback of timer node is being called(inline or at dispatcher).
+		bool              _busy(const wheel_node *pnode) const {
+			return pnode == m_firing || pnode->dispatched;
+		}
+
+		// dispatched callback is done, it can be called at any thread.
+		void              _done(wheel_node *pnode);
+
+		// take all done timer nodes as single list(link.next) in done order.
+		wheel_node*       _take_done();
+
+	protected:
+		// wheel geometry.
+		wheel_geometry m_geo;
+
+		// slot count of all levels.
+		uint32      m_slot_count;
 
+#if TIME_WHEEL_SOA_SLOTS
+		// bucket array of all levels.
+		CSlotBucket<wheel_node> *m_array;
+#else
+		// list array of all levels.
+		list_head  *m_array;
+#endif
+
+		// current tick.
+		uint64      m_tick;
+
+		// first slot of every level in m_array.
+		uint32      m_offset[max_wheel_levels];
+
+		// ticks of a slot of every level.
+		uint64      m_unit[max_wheel_levels];
+
+		// non-empty slots of m_array.
+		CSlotBitmap m_bitmap;
+
+		// timer whose callback is being called.
+		wheel_node *m_firing;
+
+		// dispatcher of parallel dispatch mode.
+		CTimerDispatcher *m_dispatcher;
+
+		// tasks of current tick for dispatcher.
+		std::vector<dispatch_task> m_tasks;
+
+		// dispatched timer count.
+		uint32      m_dispatched;
+
+		// done dispatched timers(lock-free stack by link.next).
+		std::atomic<wheel_node*> m_done;
+
+		// timer count of every state.
+		uint32      m_state_count[timer_state_released + 1];
+
+		// last time: us, it moves tick by tick.
+		int64       m_last_time;
+
+		// elapsed ticks which are not run yet, added timer counts from now then.
+		uint32      m_lag;
+	};
+
+	// cold timer entry of typed wheel: callback and payload, it is at the pool index of its node.
+	template <class Callback, class Payload>
+	struct wheel_entry {
+		Callback          func;        // callback, called as func(&data).
+		Payload           data;        // payload.
+
+		// hooks of derived entry(hidden by the same name), called by CTimeWheelT.
+		void on_state(const wheel_node*, timer_state) {}  // state is going to be changed.
+		void on_release(const wheel_node*) {}             // entry is going to be released.
+		uint64 batch_id(const wheel_node *pnode) const { return pnode->objId; } // id given to batch handler.
+	};
+
+	// typed time wheel: callback and payload are known at compile time,
+	// so firing is a direct call with typed payload, and entry is as large as it needs.
+	// wheel walks hot nodes only, entry is touched when timer is called or controlled.
+	template <class Callback, class Payload, class Entry = wheel_entry<Callback, Payload>>
+	class CTimeWheelT : public CWheelCore {
+	public:
+		typedef wheel_node                   node_type;
+		typedef Entry                        entry_type;
+		typedef CNodePool<wheel_node, Entry> node_pool;
+
+		// batch handler of timer class: payloads and ids of a tick's expired timers.
+		typedef CInlineFunc<void(const Payload *datas, const uint64 *ids, uint32 count),
+			TIMER_FUNC_INLINE_SIZE> batch_handler;
+
+		CTimeWheelT(const wheel_geometry &geo = default_geometry);
+		~CTimeWheelT();
+
+	public:
 		// update: delta tick.
 		void              update(uint32 delta);
 
 		// just run independently.
-		void              run();
+		void              run() { this->update(this->_elapsed()); }
+
+		// all timer count(any state, till it is released), O(1).
+		uint32            get_all_timer() const { return m_pool.used(); }
+
+		// make room for count more timers.
+		bool              reserve_timer(uint32 count) { return m_pool.reserve(count); }
 
-		// current index.
-		uint32            get_index() const { return m_index; }
+		// give fully free pool slabs back, but keep room for keep more timers.
+		// return released node count.
+		uint32            trim_timer(uint32 keep = 0) { return m_pool.trim(keep); }
 
-		// all timer count
-		uint32            get_all_timer() const;
+		// pool memory: bytes held and bytes of live timers.
+		size_t            get_pool_held() const { return m_pool.bytes_held(); }
+		size_t            get_pool_live() const { return m_pool.bytes_live(); }
+
+		using CWheelCore::get_left_time;
 
 		// once timer
-		bool              add_once_timer(const timer_func& func,
-			int32 delay, const attach& data = attach_
+		timer_handle      add_once_timer(Callback&& func,
+			int32 delay, const Payload& data = Payload()
 		);
 
 		// repeat timer
-		bool              add_repeated_timer(const timer_func& func,
+		timer_handle      add_repeated_timer(Callback&& func,
+			int32 delay, const Payload& data = Payload()
+		);
+
+		// timer class: expired timers of a class are delivered by one handler call per tick.
+		// return class id, 0 if there are too many classes.
+		uint32            add_timer_class(batch_handler&& handler);
+
+		// class timer, it has no callback of its own, delay 0 is the next tick.
+		timer_handle      add_class_timer(uint32 cls, int32 delay,
+			const Payload& data = Payload(), eTimerType timerType = onceType
+		);
+
+		// all handle control functions are O(1), return false if handle is invalid.
+		// kill timer
+		bool              kill_timer(const timer_handle &handle);
+
+		// interrupt timer.
+		bool              interrupt(const timer_handle &handle);
+
+		// restart timer.
+		bool              reStart(const timer_handle &handle);
+
+		// reset timer: count its delay again from now.
+		bool              reset_timer(const timer_handle &handle) {
+			return this->reset_timer(this->find_timer(handle));
+		}
+
+		// has timer(must be running state)
+		bool              has_timer(const timer_handle &handle) const;
+
+		// get left time. return -1 if it is not running, 0 if its callback is being run.
+		int64             get_left_time(const timer_handle &handle) const;
+
+		// find timer node, nullptr if it is released.
+		wheel_node*       find_timer(const timer_handle &handle) const {
+			return m_pool.find(handle.index, handle.gen);
+		}
+
+		// find timer entry, nullptr if it is released.
+		Entry*            find_entry(const timer_handle &handle) const {
+			wheel_node *pnode = this->find_timer(handle);
+			return pnode ? this->get_entry(pnode) : nullptr;
+		}
+
+		// cold entry of timer node.
+		Entry*            get_entry(const wheel_node *pnode) const { return m_pool.cold(pnode->objId); }
+
+		// handle of timer node.
+		timer_handle      get_handle(const wheel_node *pnode) const;
+
+		// change timer state, all state changes must go here to keep counters.
+		void              set_state(wheel_node *pnode, timer_state state);
+
+		// unlink timer from wheel and release it right now,
+		// timer which is being called is released after its callback.
+		void              cancel_timer(wheel_node *pnode);
+
+		// place timer again with its delay from now,
+		// repeated timer which is being called is placed after its callback anyway.
+		bool              reset_timer(wheel_node *pnode);
+
+	protected:
+		// add timer(real add timer function).
+		timer_handle      _set_timer(Callback&& func, const Payload& data,
+			int32 delay, eTimerType timerType, uint8 batch = 0
+		);
+
+		// release timer node.
+		void              _free(wheel_node *pnode);
+
+		// add timer again or release it after its callback.
+		void              _finish(wheel_node *pnode);
+
+		// finish all done dispatched timers.
+		void              _finish_dispatched();
+
+		// collect expired class timer.
+		void              _collect(wheel_node *pnode);
+
+		// call handlers of collected classes.
+		void              _deliver();
+
+		// node of link.
+		static wheel_node* _node(list_head *pos) {
+			return list_entry(pos, wheel_node, link);
+		}
+
+	protected:
+		// timer class.
+		typedef struct timer_class {
+			batch_handler        handler;
+			std::vector<Payload> datas;        // collected payloads.
+			std::vector<uint64>  ids;          // collected ids.
+		} timer_class;
+
+	protected:
+		// timer node pool.
+		node_pool m_pool;
+
+		// timer classes, id is index + 1.
+		std::vector<std::unique_ptr<timer_class>> m_classes;
+
+		// classes which have collected timers.
+		std::vector<uint8> m_pending;
+	};
+
+	template <class Callback, class Payload, class Entry>
+	CTimeWheelT<Callback, Payload, Entry>::CTimeWheelT(const wheel_geometry &geo) : CWheelCore(geo) {
+		bool r = m_pool.init(m_geo.pool_start, m_geo.pool_grow);
+		assert(r && "init error");
+		(void)r;
+	}
+
+	template <class Callback, class Payload, class Entry>
+	CTimeWheelT<Callback, Payload, Entry>::~CTimeWheelT() {
+		list_head all;
+		INIT_LIST_HEAD(&all);
+		// wait for dispatched callbacks.
+		while (m_dispatched > 0) {
+			this->_finish_dispatched();
+			std::this_thread::yield();
+		}
+
+		this->_take_all(&all);
+		while (!list_empty(&all)) {
+			wheel_node *pnode = _node(all.next);
+			list_del_init(&pnode->link);
+			this->_free(pnode);
+		}
+	}
+
+	template <class Callback, class Payload, class Entry>
+	void CTimeWheelT<Callback, Payload, Entry>::update(uint32 delta) {
+		this->_finish_dispatched();
+		if (delta <= 0) return;
+
+		// jump to the ticks which have any slot to do only.
+		list_head expired;
+		INIT_LIST_HEAD(&expired);
+		uint64 end = m_tick + delta;
+		while (this->_take_tick(end, &expired)) {
+			// callback may cancel any of expired timers.
+			while (!list_empty(&expired)) {
+				wheel_node *pnode = _node(expired.next);
+
+				// remove first.
+				list_del_init(&pnode->link);
+
+				// released outside.
+				if (removable(pnode)) {
+					this->_free(pnode);
+					continue;
+				}
+
+				// only it is running state can be done.
+				if (pnode->state == timer_state_running) {
+					// class timer is delivered with its class at the end of tick.
+					if (pnode->batch) {
+						this->_collect(pnode);
+						this->_finish(pnode);
+						continue;
+					}
+
+					// parallel dispatch: it is finished after the task is done.
+					Entry *pentry = this->get_entry(pnode);
+					if (m_dispatcher) {
+						pnode->dispatched = 1;
+						m_dispatched++;
+						m_tasks.emplace_back([this, pnode, pentry]() {
+							pentry->func(&pentry->data);
+							this->_done(pnode);
+						});
+						continue;
+					}
+
+					m_firing = pnode;
+					pentry->func(&pentry->data);
+					m_firing = nullptr;
+				}
+				this->_finish(pnode);
+			}
+
+			// class handlers.
+			if (!m_pending.empty()) {
+				this->_deliver();
+			}
+
+			// hand the tick's batch to dispatcher.
+			if (!m_tasks.empty()) {
+				m_dispatcher->dispatch(m_tasks.data(), uint32(m_tasks.size()));
+				m_tasks.clear();
+			}
+
+			// increase to next tick.
+			m_tick++;
+		}
+	}
+
+	template <class Callback, class Payload, class Entry>
+	timer_handle CTimeWheelT<Callback, Payload, Entry>::add_once_timer(Callback&& func,
+		int32 delay, const Payload& data
+	) {
+		return this->_set_timer(std::move(func), data, delay, onceType);
+	}
+
+	template <class Callback, class Payload, class Entry>
+	timer_handle CTimeWheelT<Callback, Payload, Entry>::add_repeated_timer(Callback&& func,
+		int32 delay, const Payload& data
+	) {
+		return this->_set_timer(std::move(func), data, delay, repeatedType);
+	}
+
+	template <class Callback, class Payload, class Entry>
+	uint32 CTimeWheelT<Callback, Payload, Entry>::add_timer_class(batch_handler&& handler) {
+		if (!handler || m_classes.size() >= max_timer_classes) {
+			return 0;
+		}
+
+		m_classes.emplace_back(new timer_class());
+		m_classes.back()->handler = std::move(handler);
+		return uint32(m_classes.size());
+	}
+
+	template <class Callback, class Payload, class Entry>
+	timer_handle CTimeWheelT<Callback, Payload, Entry>::add_class_timer(uint32 cls,
+		int32 delay, const Payload& data, eTimerType timerType
+	) {
+		if (cls == 0 || cls > m_classes.size()) {
+			return invalid_timer_handle;
+		}
+		return this->_set_timer(Callback(), data, delay, timerType, uint8(cls));
+	}
+
+	template <class Callback, class Payload, class Entry>
+	bool CTimeWheelT<Callback, Payload, Entry>::kill_timer(const timer_handle &handle) {
+		wheel_node *pnode = this->find_timer(handle);
+		if (!pnode || pnode->state == timer_state_killed) {
+			return false;
+		}
+
+		this->set_state(pnode, timer_state_killed);
+		this->cancel_timer(pnode);
+		return true;
+	}
+
+	template <class Callback, class Payload, class Entry>
+	bool CTimeWheelT<Callback, Payload, Entry>::interrupt(const timer_handle &handle) {
+		wheel_node *pnode = this->find_timer(handle);
+		if (!pnode || removable(pnode)) {
+			return false;
+		}
+		this->set_state(pnode, timer_state_interrupted);
+		return true;
+	}
+
+	template <class Callback, class Payload, class Entry>
+	bool CTimeWheelT<Callback, Payload, Entry>::reStart(const timer_handle &handle) {
+		wheel_node *pnode = this->find_timer(handle);
+		if (!pnode || removable(pnode)) {
+			return false;
+		}
+		this->set_state(pnode, timer_state_running);
+		return true;
+	}
+
+	template <class Callback, class Payload, class Entry>
+	bool CTimeWheelT<Callback, Payload, Entry>::has_timer(const timer_handle &handle) const {
+		const wheel_node *pnode = this->find_timer(handle);
+		return pnode && pnode->state == timer_state_running;
+	}
+
+	template <class Callback, class Payload, class Entry>
+	int64 CTimeWheelT<Callback, Payload, Entry>::get_left_time(const timer_handle &handle) const {
+		const wheel_node *pnode = this->find_timer(handle);
+		if (!pnode || pnode->state != timer_state_running) {
+			return -1;
+		}
+		return CWheelCore::get_left_time(pnode);
+	}
+
+	template <class Callback, class Payload, class Entry>
+	timer_handle CTimeWheelT<Callback, Payload, Entry>::get_handle(const wheel_node *pnode) const {
+		if (!pnode) return invalid_timer_handle;
+		timer_handle handle = { pnode->objId, m_pool.generation(pnode->objId) };
+		return handle;
+	}
+
+	template <class Callback, class Payload, class Entry>
+	void CTimeWheelT<Callback, Payload, Entry>::set_state(wheel_node *pnode, timer_state state) {
+		if (!pnode || pnode->state == state) return;
+		this->get_entry(pnode)->on_state(pnode, state);
+		this->_set_state(pnode, state);
+	}
+
+	template <class Callback, class Payload, class Entry>
+	void CTimeWheelT<Callback, Payload, Entry>::cancel_timer(wheel_node *pnode) {
+		if (!pnode) return;
+
+		// it is out of wheel now, update releases it after callback.
+		if (this->_busy(pnode)) return;
+
+		this->_unlink(pnode);
+		this->_free(pnode);
+	}
+
+	template <class Callback, class Payload, class Entry>
+	bool CTimeWheelT<Callback, Payload, Entry>::reset_timer(wheel_node *pnode) {
+		if (!pnode || removable(pnode)) {
+			return false;
+		}
+		if (this->_busy(pnode)) {
+			return pnode->timerType == repeatedType;
+		}
+
+		this->_unlink(pnode);
+		this->_add(pnode);
+		return true;
+	}
+
+	template <class Callback, class Payload, class Entry>
+	timer_handle CTimeWheelT<Callback, Payload, Entry>::_set_timer(Callback&& func,
+		const Payload& data, int32 delay, eTimerType timerType, uint8 batch
+	) {
+		if (delay < 0) {
+			assert(false && "delay time error");
+			return invalid_timer_handle;
+		}
+		if (delay == 0 && !batch) { // if delay == 0, then just call it right now.
+			assert(timerType != repeatedType && "circle timer");
+			if (timerType == repeatedType) {
+				return invalid_timer_handle;
+			}
+
+			Payload a = data;
+			func(&a);
+			return fired_timer_handle;
+		}
+
+		uint32 objId = 0;
+		wheel_node *pnode = m_pool.fetch_obj(objId);
+		assert(pnode && "alloc timer node error");
+		if (!pnode) return invalid_timer_handle;
+
+		Entry *pentry = m_pool.cold(objId);
+		pentry->func = std::move(func);
+		pentry->data = data;
+		pnode->delay = uint32(delay);
+		pnode->timerType = uint8(timerType);
+		pnode->state = timer_state_running;
+		pnode->batch = batch;
+		pnode->objId = objId;
+		INIT_LIST_HEAD(&pnode->link);
+		this->_count_new(pnode);
+
+		this->_add(pnode);
+		return this->get_handle(pnode);
+	}
+
+	template <class Callback, class Payload, class Entry>
+	void CTimeWheelT<Callback, Payload, Entry>::_free(wheel_node *pnode) {
+		if (!pnode) return;
+		this->get_entry(pnode)->on_release(pnode);
+		this->_count_free(pnode);
+		m_pool.release_obj(pnode, pnode->objId);
+	}
+
+	template <class Callback, class Payload, class Entry>
+	void CTimeWheelT<Callback, Payload, Entry>::_finish(wheel_node *pnode) {
+		// can addable now?
+		if (addable(pnode)) {
+			this->_add(pnode);
+		} else {
+			this->_free(pnode);
+		}
+	}
+
+	template <class Callback, class Payload, class Entry>
+	void CTimeWheelT<Callback, Payload, Entry>::_collect(wheel_node *pnode) {
+		timer_class *pclass = m_classes[pnode->batch - 1].get();
+		if (pclass->ids.empty()) {
+			m_pending.push_back(pnode->batch);
+		}
+		Entry *pentry = this->get_entry(pnode);
+		pclass->datas.push_back(pentry->data);
+		pclass->ids.push_back(pentry->batch_id(pnode));
+	}
+
+	template <class Callback, class Payload, class Entry>
+	void CTimeWheelT<Callback, Payload, Entry>::_deliver() {
+		// handler may add timers and classes, but no timer expires in it.
+		for (uint8 cls : m_pending) {
+			timer_class *pclass = m_classes[cls - 1].get();
+			pclass->handler(pclass->datas.data(), pclass->ids.data(), uint32(pclass->ids.size()));
+			pclass->datas.clear();
+			pclass->ids.clear();
+		}
+		m_pending.clear();
+	}
+
+	template <class Callback, class Payload, class Entry>
+	void CTimeWheelT<Callback, Payload, Entry>::_finish_dispatched() {
+		wheel_node *pnext = this->_take_done();
+		while (pnext) {
+			wheel_node *pnode = pnext;
+			pnext = pnode->link.next ? list_entry(pnode->link.next, wheel_node, link) : nullptr;
+
+			INIT_LIST_HEAD(&pnode->link);
+			pnode->dispatched = 0;
+			m_dispatched--;
+			this->_finish(pnode);
+		}
+	}
+
+	// Time wheel info: entry of type-erased wheel and register data.
+	struct wheel_info : wheel_entry<timer_func, attach> {
+		// register link, wheel_info is not standard-layout, so list_entry goes to this hook.
+		typedef struct reg_hook {
+			list_head         link;        // link of register chain.
+			wheel_info        *owner;      // info of the link.
+		} reg_hook;
+
+		uint64            id;          // timer id(it is not a unique id)
+		void(*release)(void*);         // data release func.
+		Register          *reg;        // register pointer.
+		reg_hook          reg_link;    // register link of all its timers.
+		int64             start_time;  // timer start time.
+		wheel_node        *node;       // hot node, register controls timer by it.
+
+		wheel_info() : wheel_entry(), id(0), release(nullptr), reg(nullptr), start_time(0), node(nullptr) {
+			INIT_LIST_HEAD(&reg_link.link);
+			reg_link.owner = this;
+		}
+		// can not copyable class(hook points to itself).
+		const wheel_info& operator=(const wheel_info& rhs) = delete;
+		wheel_info(const wheel_info& rhs) = delete;
+
+		// keep register running count.
+		void on_state(const wheel_node *pnode, timer_state new_state);
+
+		// release user data and remove it from register.
+		void on_release(const wheel_node *pnode);
+
+		// id given to batch handler.
+		uint64 batch_id(const wheel_node*) const { return id; }
+	};
+
+	// posted command type.
+	typedef enum {
+		command_add_timer = 0,                   // add timer.
+		command_kill_timer,                      // kill timer.
+		command_reset_timer,                     // reset timer.
+	} command_type;
+
+	// command posted from other threads.
+	typedef struct timer_command {
+		uint64     ticket;                       // timer ticket.
+		uint8      type;                         // command_type.
+		uint8      timerType;                    // eTimerType of add.
+		int32      delay;                        // delay of add: ms.
+		timer_func func;                         // callback of add.
+		attach     data;                         // attach of add.
+	} timer_command;
+
+	// timer spec of bulk add.
+	typedef struct timer_spec {
+		timer_func func;                         // callback, it is moved out.
+		uint64     id;                           // timer id, invalid_timer_id is next id of register.
+		int32      delay;                        // delay: ms.
+		eTimerType timerType;                    // timer type.
+		attach     data;                         // attach data.
+	} timer_spec;
+
+	// time wheel timer class: type-erased wheel of timer_func and attach.
+	// a wheel is not thread safe, it must be used and run at one thread only,
+	// so every thread can have its own wheel(and instance() is per thread).
+	class CTimeWheel final : public CTimeWheelT<timer_func, attach, wheel_info> {
+		friend class CTimerRegister;
+
+	public:
+		CTimeWheel(const wheel_geometry &geo = default_geometry, uint32 post_size = post_queue_size);
+		virtual ~CTimeWheel();
+		// can not copyable class.
+		const CTimeWheel& operator=(const CTimeWheel& rhs) = delete;
+		CTimeWheel(const CTimeWheel& rhs) = delete;
+
+	public:
+		// default wheel of current thread.
+		static CTimeWheel &instance();
+
+		// run posted commands first(posted timers count from now), then update.
+		void              run();
+
+		// run all posted commands in a batch, return command count.
+		uint32            run_posted();
+
+		// tickless loop: run, then sleep until next expiry(a posted command wakes it up at once).
+		// it returns when wheel is idle(no timer and no posted command) or stop_run() is called.
+		void              run_until_idle();
+
+		// busy-poll loop for a dedicated(pinned) core: it spins with cheap clock reads and
+		// cpu pause(backoff when next expiry is far), and runs the moment a tick is due
+		// or a command is posted. it returns when stop_run() is called.
+		void              run_busy_poll();
+
+		// make run_until_idle() or run_busy_poll() return, it can be called at any thread.
+		void              stop_run();
+
+		// waker of outside loop, it must live longer than posting, nullptr is none.
+		void              set_waker(CTimerWaker *waker) { m_waker.store(waker, std::memory_order_release); }
+
+		// parallel dispatch mode with built-in thread pool, 0 threads goes back to inline mode.
+		// another dispatcher can be set by set_dispatcher().
+		void              set_parallel(uint32 threads);
+
+	public:
+		// post functions can be called at any thread without lock,
+		// posted timer is added at next run() and it is controlled by returned ticket.
+		// return 0 if delay is error or command queue is full(func is not moved then).
+		uint64            post_once_timer(timer_func&& func,
+			int32 delay, const attach& data = attach_
+		);
+		uint64            post_repeated_timer(timer_func&& func,
 			int32 delay, const attach& data = attach_
 		);
 
+		// kill or reset posted timer by its ticket.
+		bool              post_kill_timer(uint64 ticket);
+		bool              post_reset_timer(uint64 ticket);
+
+		// register of posted timers(keyed by ticket), used at wheel thread only.
+		Register&         get_posted_register() { return *m_posted_reg; }
+
+		// bulk add: clock is read once, pool is reserved and timers are added in spec order.
+		// results(can be nullptr) get handle of every spec, return added count.
+		uint32            add_timers(timer_spec *specs, uint32 count, timer_handle *results = nullptr);
+
+		// bulk kill, results(can be nullptr) get kill result of every handle, return killed count.
+		uint32            kill_timers(const timer_handle *handles, uint32 count, bool *results = nullptr);
+
+		// class timer with id(given to batch handler).
+		using CTimeWheelT::add_class_timer;
+		timer_handle      add_class_timer(uint32 cls, uint64 id, int32 delay,
+			const attach& data = attach_, eTimerType timerType = onceType
+		);
+
+#if TIMER_HAS_COROUTINE
+		// awaitable sleep of coroutine: co_await wheel.sleep_for(ms), see timer_coro.h.
+		CTimerSleep       sleep_for(int32 delay);
+#endif
+
 		// add once timer at timestamp.
-		bool              add_timer_at(const timer_func &func, 
+		timer_handle      add_timer_at(timer_func &&func, 
 			int64 timestamp, const attach& data = attach_
 		);
 
 	public:
 		// all kinds of override set_timer.
-		// attach data(real add timer function)
-		wheel_info*       set_timer(const timer_func& func, const attach& data, uint64 id,
-			int32 delay, eTimerType timerType, Register *reg = nullptr
+		// attach data(real add timer function), start_time 0 is now.
+		timer_handle      set_timer(timer_func&& func, const attach& data, uint64 id,
+			int32 delay, eTimerType timerType, Register *reg = nullptr, int64 start_time = 0
 		);
 
 		// void* data.
-		wheel_info*       set_timer(const timer_func& func, void* data, uint64 id,
+		timer_handle      set_timer(timer_func&& func, void* data, uint64 id,
 			int32 delay, eTimerType timerType, Register *reg = nullptr
 		);
 		// int64 data.
-		wheel_info*       set_timer(const timer_func& func, int64 data, uint64 id,
+		timer_handle      set_timer(timer_func&& func, int64 data, uint64 id,
 			int32 delay, eTimerType timerType, Register *reg = nullptr
 		);
 		// uint64 data.
-		wheel_info*       set_timer(const timer_func& func, uint64 data, uint64 id,
+		timer_handle      set_timer(timer_func&& func, uint64 data, uint64 id,
 			int32 delay, eTimerType timerType, Register *reg = nullptr
 		);
 		// const char* data.
-		wheel_info*       set_timer(const timer_func& func, const char* data, uint64 id,
+		timer_handle      set_timer(timer_func&& func, const char* data, uint64 id,
 			int32 delay, eTimerType timerType, Register *reg = nullptr
 		);
 		// const char* data.
-		wheel_info*       set_timer(const timer_func& func, decimal data, uint64 id,
+		timer_handle      set_timer(timer_func&& func, decimal data, uint64 id,
 			int32 delay, eTimerType timerType, Register *reg = nullptr
 		);
 
 	protected:
-		// add timer info
-		void              _add(wheel_info *pinfo);
+		// post add timer command.
+		uint64            _post_timer(timer_func&& func, int32 delay,
+			eTimerType timerType, const attach& data
+		);
 
-		// remove timer info.
-		void              _release(wheel_info *pinfo);
-		void              _do_release(wheel_info *pinfo);
+		// push command, return false if it is full.
+		bool              _post(uint8 type, uint64 ticket, timer_command &&cmd);
 
-		// fetch info and init.
-		wheel_info*       _init_wheel_info(const timer_func& func, uint64 id,
-			int32 delay, eTimerType timerType, Register *reg
-		);
+		// wake up run_until_idle() if it is sleeping.
+		void              _wake();
+
+	protected:
+		// posted command queue.
+		CMpscQueue<timer_command>  m_posted;
 
-	private:
-		// list array.
-		list_head *m_array;
+		// ticket of posted timer.
+		std::atomic<uint64>        m_ticket;
 
-		// wheel index
-		uint32     m_index;
+		// register of posted timers.
+		std::unique_ptr<Register>  m_posted_reg;
 
-		// wheel info pool.
-		wheel_pool m_pool;
+		// built-in thread pool of parallel dispatch mode.
+		std::unique_ptr<CTimerDispatcher> m_thread_pool;
 
-		// last time: ms
-		int64      m_last_time;
+		// sleep of run_until_idle(), m_wakeup is guarded by m_wait_lock.
+		std::mutex                 m_wait_lock;
+		std::condition_variable    m_wait_cond;
+		std::atomic<bool>          m_sleeping;
+		bool                       m_wakeup;
 
-		// timer object id.
-		uint32     m_next_objId;
+		// stop run loop, it is set under m_wait_lock.
+		std::atomic<bool>          m_stop;
+
+		// waker of outside loop.
+		std::atomic<CTimerWaker*>  m_waker;
 	};
 
 
 	// add right value reference.
 	class CTimerRegister {
+		friend class CTimeWheel;
+		friend struct wheel_info;
+
 	public:
-		CTimerRegister();
+		// register is bound to a wheel, and the wheel must live longer than it.
+		CTimerRegister(CTimeWheel &wheel = CTimeWheel::instance());
 		virtual ~CTimerRegister();
 		// can not copyable class.
 		const CTimerRegister& operator =(const CTimerRegister& rhs) = delete;
 		CTimerRegister(const CTimerRegister& rhs) = delete;
-		typedef std::map<uint64, wheel_info*> timer_map;
+		typedef CFlatMap<wheel_info*> timer_map;
 
 	public:
 		// repeated timer.
-		add_timer_ret   add_repeated_timer(const timer_func&& func,
+		add_timer_ret   add_repeated_timer(timer_func&& func,
 			uint64 id, int32 delay, const attach &data = attach_,
 			bool remove = true, void(*release_func)(void*) = nullptr
 		);
 
 		// once timer.
-		add_timer_ret   add_once_timer(const timer_func&& func,
+		add_timer_ret   add_once_timer(timer_func&& func,
 			uint64 id, int32 delay, const attach &data = attach_,
 			bool remove = true, void(*release_func)(void*) = nullptr
 		);
 
 		// run at timestamp
-		add_timer_ret   add_timer_at(const timer_func&& func,
+		add_timer_ret   add_timer_at(timer_func&& func,
 			uint64 id, int64 timestamp, const attach &data = attach_,
 			bool remove = true, void(*release_func)(void*) = nullptr
 		);
 
+		// handle timers have no id, they are controlled by returned handle only.
+		// repeated timer.
+		timer_handle    add_repeated_timer(timer_func&& func,
+			int32 delay, const attach &data = attach_,
+			void(*release_func)(void*) = nullptr
+		);
+
+		// once timer.
+		timer_handle    add_once_timer(timer_func&& func,
+			int32 delay, const attach &data = attach_,
+			void(*release_func)(void*) = nullptr
+		);
+
 #if defined(_WIN32)
 		// Variadic Templates function
 		template <class Fn, class... Args>
@@ -352,26 +1215,26 @@ namespace STimeWheelSpace {
 		// id can be INVALID_TIMER_ID to ignore timer id.
 		// all add_timer function if it is lambda, can not use & to use parameter.
 		// int64 para
-		add_timer_ret    add_timer(const timer_func&& func,
+		add_timer_ret    add_timer(timer_func&& func,
 			int64 data, uint64 id, int32 delay, bool loop = false,
 			bool remove = true, void(*release_func)(void*) = nullptr
 		);
 		// uint64 para
-		add_timer_ret    add_timer(const timer_func&& func,
+		add_timer_ret    add_timer(timer_func&& func,
 			uint64 data, uint64 id, int32 delay, bool loop = false,
 			bool remove = true, void(*release_func)(void*) = nullptr
 		);
 		// void* para
-		add_timer_ret   add_timer(const timer_func&& func,
+		add_timer_ret   add_timer(timer_func&& func,
 			void *data, uint64 id, int32 delay, bool loop = false,
 			bool remove = true, void(*release_func)(void*) = nullptr
 		);
 		// const char[]
-		add_timer_ret    add_timer(const timer_func&& func,
+		add_timer_ret    add_timer(timer_func&& func,
 			const char data[], uint64 id, int32 delay, bool loop = false,
 			bool remove = true, void(*release_func)(void*) = nullptr
 		);
-		add_timer_ret    add_timer(const timer_func&& func,
+		add_timer_ret    add_timer(timer_func&& func,
 			decimal data, uint64 id, int32 delay, bool loop = false,
 			bool remove = true, void(*release_func)(void*) = nullptr
 		);
@@ -385,9 +1248,31 @@ namespace STimeWheelSpace {
 		// restart timer.
 		bool             reStart(uint64 id);
 
+		// reset timer: count its delay again from now.
+		bool             reset_timer(uint64 id);
+
 		// kill all timer.
 		void             kill_all_timer();
 
+		// bulk add: clock is read once, pool and map are reserved and timers are added in spec order,
+		// so ids and replacing are the same as adding them one by one.
+		// results(can be nullptr) get add result of every spec, return added count.
+		uint32           add_timers(timer_spec *specs, uint32 count, add_timer_ret *results = nullptr,
+			bool remove = true, void(*release_func)(void*) = nullptr
+		);
+
+		// bulk kill, results(can be nullptr) get kill result of every id, return killed count.
+		uint32           kill_timers(const uint64 *ids, uint32 count, bool *results = nullptr);
+
+		// handle version of control functions, handle must be added by this register.
+		bool             kill_timer(const timer_handle &handle);
+		bool             interrupt(const timer_handle &handle);
+		bool             reStart(const timer_handle &handle);
+		bool             reset_timer(const timer_handle &handle);
+		bool             has_timer(const timer_handle &handle) const;
+		int64            get_left_time(const timer_handle &handle) const;
+		wheel_info*      find_timer(const timer_handle &handle) const;
+
 		// remove id timer. called only at CTimeWheel class
 		// it must check whether it is the same timer.
 		void             remove_timer(wheel_info *info);
@@ -402,14 +1287,17 @@ namespace STimeWheelSpace {
 		// get left time. return -1 if has not id timer.
 		int64            get_left_time(uint64 id) const;
 
-		// next timer id.
-		uint64           next_id() const;
+		// next timer id: larger than any id used, O(1).
+		uint64           next_id() const { return m_next_id; }
 
 		// iterator all timers
 		void             traverse();
 
-		// get timer count
-		uint32           get_timer_count() const;
+		// get running timer count, O(1).
+		uint32           get_timer_count() const { return m_running; }
+
+		// bound wheel.
+		CTimeWheel&      get_wheel() const { return m_wheel; }
 
 		// get timer attach.
 		const attach*    get_timer_attach(uint64 id);
@@ -423,10 +1311,35 @@ namespace STimeWheelSpace {
 		// can not called outside: release all timer data, I am released normally.
 		void             _release_all_timer();
 
+		// free all timers of chain right now with state.
+		void             _free_all_timer(timer_state state);
+
 		// timer check: remove denote whether remove existed timer.
 		add_timer_ret    _repeat_timer_check(bool remove, uint64 id);
 
+		// add id timer, all id add functions go here, start time 0 is now.
+		add_timer_ret    _add_id_timer(timer_func&& func, uint64 id, int32 delay, eTimerType timerType,
+			const attach &data, bool remove, void(*release_func)(void*), int64 start_time
+		);
+
+		// add handle timer.
+		timer_handle     _add_handle_timer(timer_func&& func, int32 delay,
+			eTimerType timerType, const attach &data, void(*release_func)(void*)
+		);
+
 	protected:
+		// bound wheel.
+		CTimeWheel &m_wheel;
+
 		timer_map m_timer;
+
+		// all timers(id and handle timers) list, teardown walks it only.
+		list_head m_chain;
+
+		// next timer id.
+		uint64    m_next_id;
+
+		// running timer count, kept by CTimeWheel::set_state.
+		uint32    m_running;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,147 @@
+
+// note  : c++20 coroutine awaitables of time wheel.
+// idea  : awaiter keeps the coroutine handle in its timer callback(inline, no allocation),
+//         and it kills its timer when it goes with a destroyed coroutine, so wheel never
+//         resumes a dead coroutine.
+//         with_timeout() races an awaitable which can be cancelled(bool cancel()) with a
+//         timer, the loser is cancelled. all of them are used at wheel thread only.
+
+#pragma once
+
+#include "time_wheel.h"
+
+#if TIMER_HAS_COROUTINE
+
+#include <coroutine>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace STimeWheelSpace {
+	// awaitable sleep: co_await wheel.sleep_for(ms).
+	class CTimerSleep final {
+	public:
+		CTimerSleep(CTimeWheel &wheel, int32 delay) : m_wheel(wheel), m_delay(delay),
+			m_handle(invalid_timer_handle) {}
+		CTimerSleep(CTimerSleep &&rhs) noexcept : m_wheel(rhs.m_wheel), m_delay(rhs.m_delay),
+			m_handle(rhs.m_handle) {
+			rhs.m_handle = invalid_timer_handle;
+		}
+		~CTimerSleep() { this->cancel(); }
+		// can not copyable class.
+		const CTimerSleep& operator=(const CTimerSleep& rhs) = delete;
+		CTimerSleep(const CTimerSleep& rhs) = delete;
+
+	public:
+		bool              await_ready() const noexcept { return m_delay <= 0; }
+
+		// add timer fail: go on right now.
+		bool              await_suspend(std::coroutine_handle<> coro) {
+			m_handle = m_wheel.add_once_timer([coro](void*) { coro.resume(); }, m_delay);
+			return bool(m_handle);
+		}
+
+		void              await_resume() noexcept { m_handle = invalid_timer_handle; }
+
+		// kill timer, return true if coroutine is not going to be resumed by it.
+		bool              cancel() {
+			if (!m_handle) return false;
+			bool r = m_wheel.kill_timer(m_handle);
+			m_handle = invalid_timer_handle;
+			return r;
+		}
+
+	protected:
+		CTimeWheel        &m_wheel;
+		int32             m_delay;
+		timer_handle      m_handle;
+	};
+
+	inline CTimerSleep CTimeWheel::sleep_for(int32 delay) {
+		return CTimerSleep(*this, delay);
+	}
+
+	// awaitable with timeout, inner awaitable must have bool cancel() which returns
+	// true if it is not going to resume the coroutine any more.
+	template <class Awaitable>
+	class CTimerTimeout final {
+	protected:
+		typedef decltype(std::declval<Awaitable&>().await_resume()) inner_result;
+
+	public:
+		// done in time: true for void awaitable, or its result, nullopt if it is timeout.
+		typedef std::conditional_t<std::is_void_v<inner_result>, bool, std::optional<inner_result>> result_type;
+
+		CTimerTimeout(Awaitable &&inner, int32 delay, CTimeWheel &wheel) : m_inner(std::move(inner)),
+			m_wheel(wheel), m_delay(delay), m_handle(invalid_timer_handle), m_timeout(false) {}
+		~CTimerTimeout() {
+			if (m_handle) m_wheel.kill_timer(m_handle);
+		}
+		// can not copyable class.
+		const CTimerTimeout& operator=(const CTimerTimeout& rhs) = delete;
+		CTimerTimeout(const CTimerTimeout& rhs) = delete;
+
+	public:
+		// no time left: it is timeout unless inner is ready.
+		bool              await_ready() {
+			if (m_inner.await_ready()) return true;
+			m_timeout = (m_delay <= 0);
+			return m_timeout;
+		}
+
+		bool              await_suspend(std::coroutine_handle<> coro) {
+			// timer goes first, wheel does not run in inner await_suspend.
+			m_handle = m_wheel.add_once_timer([this, coro](void*) {
+				m_handle = invalid_timer_handle;
+				if (m_inner.cancel()) {
+					m_timeout = true;
+					coro.resume();
+				}
+			}, m_delay);
+
+			typedef decltype(m_inner.await_suspend(coro)) suspend_type;
+			if constexpr (std::is_same_v<suspend_type, bool>) {
+				if (!m_inner.await_suspend(coro)) {
+					return false;
+				}
+			} else {
+				static_assert(std::is_void_v<suspend_type>, "await_suspend must return void or bool");
+				m_inner.await_suspend(coro);
+			}
+			return true;
+		}
+
+		result_type       await_resume() {
+			if (m_handle) {
+				m_wheel.kill_timer(m_handle);
+				m_handle = invalid_timer_handle;
+			}
+			if constexpr (std::is_void_v<inner_result>) {
+				if (m_timeout) return false;
+				m_inner.await_resume();
+				return true;
+			} else {
+				if (m_timeout) return std::nullopt;
+				return result_type(m_inner.await_resume());
+			}
+		}
+
+	protected:
+		Awaitable         m_inner;
+		CTimeWheel        &m_wheel;
+		int32             m_delay;
+		timer_handle      m_handle;
+		bool              m_timeout;
+	};
+
+	// co_await with_timeout(awaitable, ms).
+	template <class Awaitable>
+	CTimerTimeout<std::decay_t<Awaitable>> with_timeout(Awaitable &&inner, int32 delay,
+		CTimeWheel &wheel = CTimeWheel::instance()
+	) {
+		static_assert(!std::is_lvalue_reference_v<Awaitable>, "awaitable is moved into timeout");
+		return CTimerTimeout<std::decay_t<Awaitable>>(std::move(inner), delay, wheel);
+	}
+}
+
+#endif
@@ -0,0 +1,27 @@
+#include "timer_deadline.h"
+
+namespace STimeWheelSpace {
+	CDeadline::CDeadline(timer_func&& func, int32 delay, CTimeWheel &wheel) : m_wheel(&wheel),
+		m_handle(invalid_timer_handle) {
+		// delay 0 is called right now, and its handle is never found.
+		m_handle = wheel.add_once_timer(std::move(func), delay);
+	}
+
+	CDeadline& CDeadline::operator=(CDeadline &&rhs) noexcept {
+		if (this != &rhs) {
+			this->disarm();
+			m_wheel = rhs.m_wheel;
+			m_handle = rhs.m_handle;
+			rhs.m_handle = invalid_timer_handle;
+		}
+		return *this;
+	}
+
+	bool CDeadline::disarm() {
+		if (!m_handle) return false;
+
+		bool r = m_wheel->kill_timer(m_handle);
+		m_handle = invalid_timer_handle;
+		return r;
+	}
+}
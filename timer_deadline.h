@@ -0,0 +1,54 @@
+
+// note  : deadline guard: a timer which is almost always disarmed before it expires(as rpc deadline).
+// idea  : guard arms a once timer at construction and keeps its handle only, so disarm is a
+//         generation check plus an unlink and the node goes back to pool at once, there is no
+//         register map, no delayed release and no allocation(callback is inline).
+//         guard is movable, and a handle of an expired timer is simply stale, so the guard
+//         never needs to hear from its callback. it is used at wheel thread only.
+
+#pragma once
+
+#include "time_wheel.h"
+
+namespace STimeWheelSpace {
+	class CDeadline final {
+	public:
+		// empty guard, nothing is armed.
+		CDeadline() : m_wheel(nullptr), m_handle(invalid_timer_handle) {}
+
+		// arm func after delay(ms), wheel must live longer than guard.
+		CDeadline(timer_func&& func, int32 delay, CTimeWheel &wheel = CTimeWheel::instance());
+
+		CDeadline(CDeadline &&rhs) noexcept : m_wheel(rhs.m_wheel), m_handle(rhs.m_handle) {
+			rhs.m_handle = invalid_timer_handle;
+		}
+		CDeadline& operator=(CDeadline &&rhs) noexcept;
+		~CDeadline() { this->disarm(); }
+		// can not copyable class.
+		const CDeadline& operator=(const CDeadline& rhs) = delete;
+		CDeadline(const CDeadline& rhs) = delete;
+
+	public:
+		// disarm it(done in time), O(1), return false if it is expired or not armed.
+		bool              disarm();
+
+		// it is armed and not expired yet.
+		bool              armed() const { return m_wheel && m_wheel->has_timer(m_handle); }
+
+		// count its delay again from now, return false if it is expired or not armed.
+		bool              reset() { return m_wheel && m_wheel->reset_timer(m_handle); }
+
+		// left time: ms, -1 if it is expired or not armed.
+		int64             get_left_time() const { return m_wheel ? m_wheel->get_left_time(m_handle) : -1; }
+
+		// handle of armed timer.
+		const timer_handle& get_handle() const { return m_handle; }
+
+	protected:
+		// bound wheel, nullptr for empty guard.
+		CTimeWheel       *m_wheel;
+
+		// armed timer, it is stale after expiry.
+		timer_handle      m_handle;
+	};
+}
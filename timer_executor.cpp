@@ -0,0 +1,185 @@
+#include "timer_executor.h"
+#include <chrono>
+
+namespace STimeWheelSpace {
+	// shard owned by current thread, it is set at worker thread only.
+	static thread_local const void *worker_shard = nullptr;
+
+	CTimerExecutor::CTimerExecutor(uint32 shards, const wheel_geometry &geo, uint32 post_size) :
+		m_tick_us(geo.tick_us), m_running(false) {
+		if (shards == 0) {
+			shards = std::thread::hardware_concurrency();
+		}
+		if (shards == 0) shards = 1;
+		if (shards > max_executor_shards) shards = max_executor_shards;
+
+		for (uint32 i = 0; i < shards; i++) {
+			m_shards.emplace_back(new shard());
+			m_shards.back()->wheel.reset(new CTimeWheel(geo, post_size));
+		}
+	}
+
+	CTimerExecutor::~CTimerExecutor() {
+		this->stop();
+	}
+
+	bool CTimerExecutor::start() {
+		if (m_running.exchange(true)) {
+			return false;
+		}
+		for (uint32 i = 0; i < get_shard_count(); i++) {
+			m_shards[i]->worker = std::thread(&CTimerExecutor::_work, this, i);
+		}
+		return true;
+	}
+
+	void CTimerExecutor::stop() {
+		if (!m_running.exchange(false)) {
+			return;
+		}
+		// join all workers first, a running worker may steal from any shard.
+		for (auto &s : m_shards) {
+			if (s->worker.joinable()) {
+				s->worker.join();
+			}
+		}
+		for (auto &s : m_shards) {
+			std::lock_guard<std::mutex> guard(s->lock);
+			s->staged.clear();
+			s->ready.clear();
+		}
+	}
+
+	uint32 CTimerExecutor::get_shard(uint64 key) const {
+		return uint32(mix_key(key) % m_shards.size());
+	}
+
+	uint64 CTimerExecutor::get_executed() const {
+		uint64 count = 0;
+		for (auto &s : m_shards) {
+			count += s->executed.load(std::memory_order_relaxed);
+		}
+		return count;
+	}
+
+	uint64 CTimerExecutor::get_stolen() const {
+		uint64 count = 0;
+		for (auto &s : m_shards) {
+			count += s->stolen.load(std::memory_order_relaxed);
+		}
+		return count;
+	}
+
+	uint64 CTimerExecutor::add_once_timer(uint64 key, timer_func&& func,
+		int32 delay, const attach& data
+	) {
+		return this->_add_timer(key, std::move(func), delay, onceType, data);
+	}
+
+	uint64 CTimerExecutor::add_repeated_timer(uint64 key, timer_func&& func,
+		int32 delay, const attach& data
+	) {
+		return this->_add_timer(key, std::move(func), delay, repeatedType, data);
+	}
+
+	bool CTimerExecutor::kill_timer(uint64 ticket) {
+		uint32 index = uint32(ticket >> 56);
+		if (index >= get_shard_count()) return false;
+		return m_shards[index]->wheel->post_kill_timer(ticket & ((uint64(1) << 56) - 1));
+	}
+
+	bool CTimerExecutor::reset_timer(uint64 ticket) {
+		uint32 index = uint32(ticket >> 56);
+		if (index >= get_shard_count()) return false;
+		return m_shards[index]->wheel->post_reset_timer(ticket & ((uint64(1) << 56) - 1));
+	}
+
+	uint64 CTimerExecutor::_add_timer(uint64 key, timer_func&& func,
+		int32 delay, eTimerType timerType, const attach& data
+	) {
+		if (!func || delay < 0 || (delay == 0 && timerType == repeatedType)) {
+			return 0;
+		}
+
+		uint32 index = this->get_shard(key);
+		shard *s = m_shards[index].get();
+		bool once = (timerType == onceType);
+
+		// wheel callback only stages the job, it is called at the shard worker.
+		timer_func wrap = [s, once, ref = exec_ref(std::make_shared<exec_timer>(std::move(func)))](void *p) mutable {
+			ready_job job;
+			if (once) { // once timer is released right after, job takes it.
+				job.timer = std::move(ref.timer);
+			} else {
+				job.timer = ref.timer;
+			}
+			job.data = *(attach*)p;
+			s->staged.push_back(std::move(job));
+		};
+
+		// queue full: owner worker(a callback adds to its own shard) takes commands itself,
+		// for nobody else takes them, and the others fail as the post api of wheel.
+		uint64 ticket = 0;
+		while (!(ticket = once ? s->wheel->post_once_timer(std::move(wrap), delay, data) :
+			s->wheel->post_repeated_timer(std::move(wrap), delay, data))) {
+			if (worker_shard != s || !m_running.load(std::memory_order_relaxed)) {
+				return 0;
+			}
+			// expired callbacks are staged only, they are run after current job.
+			s->wheel->run();
+		}
+		return _ticket(index, ticket);
+	}
+
+	void CTimerExecutor::_work(uint32 index) {
+		shard &s = *m_shards[index];
+		uint32 count = get_shard_count();
+		worker_shard = &s;
+		while (m_running.load(std::memory_order_relaxed)) {
+			s.wheel->run();
+			this->_flush(s);
+
+			// own jobs first, then steal from others.
+			if (this->_run_one(s, s)) {
+				continue;
+			}
+			bool stolen = false;
+			for (uint32 i = 1; i < count && !stolen; i++) {
+				stolen = this->_run_one(*m_shards[(index + i) % count], s);
+			}
+			if (!stolen) {
+				std::this_thread::sleep_for(std::chrono::microseconds(m_tick_us));
+			}
+		}
+	}
+
+	void CTimerExecutor::_flush(shard &s) {
+		if (s.staged.empty()) return;
+
+		std::lock_guard<std::mutex> guard(s.lock);
+		for (auto &job : s.staged) {
+			s.ready.push_back(std::move(job));
+		}
+		s.staged.clear();
+	}
+
+	bool CTimerExecutor::_run_one(shard &s, shard &runner) {
+		ready_job job;
+		{
+			std::lock_guard<std::mutex> guard(s.lock);
+			if (s.ready.empty()) return false;
+			job = std::move(s.ready.front());
+			s.ready.pop_front();
+		}
+
+		// killed after it is queued.
+		if (job.timer->alive.load(std::memory_order_relaxed)) {
+			job.timer->func(&job.data);
+		}
+		runner.executed.fetch_add(1, std::memory_order_relaxed);
+		if (&s != &runner) {
+			runner.stolen.fetch_add(1, std::memory_order_relaxed);
+		}
+		return true;
+	}
+}
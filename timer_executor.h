@@ -0,0 +1,135 @@
+
+// note  : sharded multi-thread timer executor.
+// idea  : every worker thread owns a wheel shard, timer is routed to a shard by key hash
+//         and added by the lock-free post api of the shard wheel.
+//         expired callback is not called at wheel tick, it is queued to ready queue of
+//         its shard, the owner worker runs it, and an idle worker steals it from the
+//         front of the queue, so callbacks of a shard always start in expiry order.
+//         callbacks run at any worker, so they must be thread safe, and a repeated
+//         callback slower than its delay may be run at two workers at the same time.
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include "time_wheel.h"
+
+namespace STimeWheelSpace {
+	// max shard count: high 8 bits of ticket is shard.
+	static constexpr uint32 max_executor_shards = 256;
+
+	class CTimerExecutor final {
+	protected:
+		// timer callback shared by wheel node and queued jobs,
+		// it is not alive after the node is killed or released.
+		typedef struct exec_timer {
+			timer_func         func;
+			std::atomic<bool>  alive;
+			exec_timer(timer_func &&f) : func(std::move(f)), alive(true) {}
+		} exec_timer;
+
+		// callback reference kept by wheel node,
+		// repeated timer is not alive any more when its node is released.
+		typedef struct exec_ref {
+			std::shared_ptr<exec_timer> timer;
+			exec_ref(std::shared_ptr<exec_timer> &&t) : timer(std::move(t)) {}
+			exec_ref(exec_ref &&rhs) noexcept = default;
+			~exec_ref() {
+				if (timer) timer->alive.store(false, std::memory_order_relaxed);
+			}
+		} exec_ref;
+
+		// expired callback waiting to be run.
+		typedef struct ready_job {
+			std::shared_ptr<exec_timer> timer;
+			attach                      data;
+		} ready_job;
+
+		// a wheel shard and its worker.
+		typedef struct shard {
+			std::unique_ptr<CTimeWheel> wheel;
+			std::thread                 worker;
+			std::mutex                  lock;       // lock of ready.
+			std::deque<ready_job>       ready;      // ready jobs, run from front.
+			std::vector<ready_job>      staged;     // jobs of current tick, worker thread only.
+			std::atomic<uint64>         executed;   // executed job count.
+			std::atomic<uint64>         stolen;     // job count stolen by this worker.
+			shard() : executed(0), stolen(0) {}
+		} shard;
+
+	public:
+		// shard count 0 means hardware concurrency.
+		CTimerExecutor(uint32 shards = 0, const wheel_geometry &geo = default_geometry,
+			uint32 post_size = post_queue_size
+		);
+		~CTimerExecutor();
+		// can not copyable class.
+		const CTimerExecutor& operator=(const CTimerExecutor& rhs) = delete;
+		CTimerExecutor(const CTimerExecutor& rhs) = delete;
+
+	public:
+		// start and stop all workers, queued jobs are dropped at stop.
+		bool              start();
+		void              stop();
+
+		// all following functions can be called at any thread(callbacks too).
+		// key routes timer to a shard(register pointer, object id and so on),
+		// timers of the same key are at the same shard.
+		// return ticket, 0 if it is failed or post queue of the shard is full
+		// (a callback adding to its own shard never sees full).
+		uint64            add_once_timer(uint64 key, timer_func&& func,
+			int32 delay, const attach& data = attach_
+		);
+		uint64            add_repeated_timer(uint64 key, timer_func&& func,
+			int32 delay, const attach& data = attach_
+		);
+
+		// kill timer, queued job of repeated timer is not run either.
+		bool              kill_timer(uint64 ticket);
+
+		// reset timer: count its delay again from now.
+		bool              reset_timer(uint64 ticket);
+
+	public:
+		uint32            get_shard_count() const { return uint32(m_shards.size()); }
+		uint32            get_shard(uint64 key) const;
+
+		// executed job count of all shards.
+		uint64            get_executed() const;
+
+		// stolen job count of all shards.
+		uint64            get_stolen() const;
+
+	protected:
+		uint64            _add_timer(uint64 key, timer_func&& func,
+			int32 delay, eTimerType timerType, const attach& data
+		);
+
+		// worker loop.
+		void              _work(uint32 index);
+
+		// move staged jobs to ready queue.
+		void              _flush(shard &s);
+
+		// run a job from front of the shard, return false if there is none.
+		bool              _run_one(shard &s, shard &runner);
+
+		static uint64     _ticket(uint32 index, uint64 ticket) {
+			return ticket ? (uint64(index) << 56) | ticket : 0;
+		}
+
+	protected:
+		// shards.
+		std::vector<std::unique_ptr<shard>> m_shards;
+
+		// tick length: us.
+		uint32            m_tick_us;
+
+		// workers are running.
+		std::atomic<bool> m_running;
+	};
+}
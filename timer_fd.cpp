@@ -0,0 +1,86 @@
+#include "timer_fd.h"
+
+#if defined(__linux__)
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <time.h>
+
+namespace STimeWheelSpace {
+	// a past time, fd expires at once.
+	static constexpr int64 arm_now_time = 1;
+
+	CTimerFdDriver::CTimerFdDriver(CTimeWheel &wheel) : m_wheel(wheel), m_fd(-1),
+		m_armed(0), m_woken(false) {
+	}
+
+	CTimerFdDriver::~CTimerFdDriver() {
+		if (m_fd >= 0) {
+			m_wheel.set_waker(nullptr);
+			close(m_fd);
+			m_fd = -1;
+		}
+	}
+
+	bool CTimerFdDriver::init() {
+		if (m_fd >= 0) return false;
+
+		// wheel time is steady clock, it is CLOCK_MONOTONIC on linux.
+		m_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if (m_fd < 0) {
+			return false;
+		}
+		m_wheel.set_waker(this);
+		this->rearm();
+		return true;
+	}
+
+	void CTimerFdDriver::on_readable() {
+		uint64 expired = 0;
+		ssize_t r = read(m_fd, &expired, sizeof(expired));
+		(void)r;
+
+		// fd is one-shot, and a post after this point arms it again.
+		m_armed = -1;
+		m_woken.store(false, std::memory_order_seq_cst);
+
+		m_wheel.run();
+		this->rearm();
+	}
+
+	void CTimerFdDriver::rearm() {
+		// armed to now by wake.
+		if (m_fd < 0 || m_woken.load(std::memory_order_seq_cst)) return;
+
+		uint64 next = m_wheel.next_wake_tick();
+		int64 time = (next == no_expiry) ? 0 : m_wheel.get_tick_time(next);
+		if (time == m_armed) return;
+
+		this->_arm(time);
+		m_armed = time;
+
+		// a wake between may be overwritten above.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_woken.load(std::memory_order_relaxed)) {
+			this->_arm(arm_now_time);
+			m_armed = -1;
+		}
+	}
+
+	void CTimerFdDriver::wake() {
+		if (!m_woken.exchange(true, std::memory_order_seq_cst)) {
+			this->_arm(arm_now_time);
+		}
+	}
+
+	bool CTimerFdDriver::_arm(int64 time) {
+		struct itimerspec its = {};
+		if (time > 0) {
+			its.it_value.tv_sec = time_t(time / 1000000);
+			its.it_value.tv_nsec = long(time % 1000000) * 1000;
+		}
+		return timerfd_settime(m_fd, TFD_TIMER_ABSTIME, &its, nullptr) == 0;
+	}
+}
+
+#endif
@@ -0,0 +1,62 @@
+
+// note  : timerfd driver of time wheel for epoll loop(linux only).
+// idea  : driver owns a timerfd which is armed(absolute monotonic time) to the wheel's
+//         next expiry, so the fd can be added to an existing epoll set and the wheel
+//         shares the io thread without any polling or guessed epoll_wait timeout.
+//         at readiness the wheel runs the exact elapsed ticks and the fd is armed again,
+//         and a command posted from other threads arms it to now.
+
+#pragma once
+
+#if defined(__linux__)
+
+#include <atomic>
+#include "time_wheel.h"
+
+namespace STimeWheelSpace {
+	class CTimerFdDriver final : public CTimerWaker {
+	public:
+		// wheel must live longer than driver, and it is run at the io thread only.
+		CTimerFdDriver(CTimeWheel &wheel = CTimeWheel::instance());
+		virtual ~CTimerFdDriver();
+		// can not copyable class.
+		const CTimerFdDriver& operator=(const CTimerFdDriver& rhs) = delete;
+		CTimerFdDriver(const CTimerFdDriver& rhs) = delete;
+
+	public:
+		// create timerfd(non-blocking) and arm it, it is the waker of wheel then.
+		bool              init();
+
+		// timerfd to be added to epoll set(EPOLLIN), -1 before init.
+		int               fd() const { return m_fd; }
+
+		// fd is readable: run wheel and arm fd again.
+		void              on_readable();
+
+		// arm fd to next expiry if it is changed,
+		// call it after timers are added or killed out of wheel callbacks(before epoll_wait).
+		void              rearm();
+
+		// CTimerWaker: posted command, fd is armed to now(any thread).
+		virtual void      wake() override;
+
+	protected:
+		// arm fd at absolute time(us), 0 is disarm.
+		bool              _arm(int64 time);
+
+	protected:
+		// driven wheel.
+		CTimeWheel        &m_wheel;
+
+		// timerfd.
+		int               m_fd;
+
+		// armed time(us), 0 is disarmed, -1 is unknown(expired or woken).
+		int64             m_armed;
+
+		// woken by posting thread, it is cleared when wheel runs.
+		std::atomic<bool> m_woken;
+	};
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "timer_group.h"
+
+namespace STimeWheelSpace {
+	CTimerGroup::CTimerGroup(CTimeWheel &wheel) : m_wheel(wheel),
+		m_handle(invalid_timer_handle), m_round(0) {
+	}
+
+	CTimerGroup::~CTimerGroup() {
+		this->stop();
+	}
+
+	bool CTimerGroup::start(member_func&& func, int32 period) {
+		if (!func || period <= 0) {
+			return false;
+		}
+
+		this->stop();
+		m_func = std::move(func);
+		m_handle = m_wheel.add_repeated_timer([this](void*) { this->_fire(); }, period);
+		return bool(m_handle);
+	}
+
+	void CTimerGroup::stop() {
+		if (m_handle) {
+			m_wheel.kill_timer(m_handle);
+			m_handle = invalid_timer_handle;
+		}
+	}
+
+	bool CTimerGroup::add_member(uint64 id, const attach &data) {
+		if (this->has_member(id)) {
+			return false;
+		}
+
+		// new member is not called in current round.
+		member m = { id, data, m_round };
+		m_index[id] = uint32(m_members.size());
+		m_members.push_back(m);
+		return true;
+	}
+
+	bool CTimerGroup::remove_member(uint64 id) {
+		auto it = m_index.find(id);
+		if (it == m_index.end()) {
+			return false;
+		}
+
+		// swap-remove: last member takes its place.
+		uint32 index = it->second;
+		m_index.erase(it);
+		if (index + 1 < m_members.size()) {
+			m_members[index] = m_members.back();
+			m_index[m_members[index].id] = index;
+		}
+		m_members.pop_back();
+		return true;
+	}
+
+	attach* CTimerGroup::get_member(uint64 id) {
+		auto it = m_index.find(id);
+		return it != m_index.end() ? &m_members[it->second].data : nullptr;
+	}
+
+	void CTimerGroup::clear() {
+		m_members.clear();
+		m_index.clear();
+	}
+
+	void CTimerGroup::_fire() {
+		// a member moved by swap-remove may come again, round skips it.
+		uint32 round = ++m_round;
+		uint32 i = uint32(m_members.size());
+		while (i > 0 && m_handle) {
+			// members are removed in callback.
+			if (i > m_members.size()) {
+				i = uint32(m_members.size());
+				continue;
+			}
+
+			member &m = m_members[--i];
+			if (m.round == round) continue;
+			m.round = round;
+			m_func(m.id, &m.data);
+		}
+	}
+}
@@ -0,0 +1,85 @@
+
+// note  : timer group: one repeated wheel timer drives many members.
+// idea  : members with the same period are kept in a dense array, and one wheel
+//         node calls them all at expiry, so a period costs one wheel operation.
+//         member is found by a sparse map(id -> dense index), and removed by swap-remove.
+
+#pragma once
+
+#include <vector>
+#include "time_wheel.h"
+
+namespace STimeWheelSpace {
+	class CTimerGroup final {
+	public:
+		// member callback: member id and its data(it is moved by add_member in callback).
+		typedef CInlineFunc<void(uint64 id, attach *data), TIMER_FUNC_INLINE_SIZE> member_func;
+
+	protected:
+		// dense member.
+		typedef struct member {
+			uint64            id;          // member id.
+			attach            data;        // member data.
+			uint32            round;       // last round it is called.
+		} member;
+
+	public:
+		CTimerGroup(CTimeWheel &wheel = CTimeWheel::instance());
+		~CTimerGroup();
+		// can not copyable class.
+		const CTimerGroup& operator=(const CTimerGroup& rhs) = delete;
+		CTimerGroup(const CTimerGroup& rhs) = delete;
+
+	public:
+		// start group timer, every period all members are called.
+		bool              start(member_func&& func, int32 period);
+
+		// stop group timer, members are kept.
+		void              stop();
+
+		// group timer is running.
+		bool              is_running() const { return bool(m_handle); }
+
+		// add member, O(1), return false if it exists.
+		// member added in callback is called from next period.
+		bool              add_member(uint64 id, const attach &data = attach_);
+
+		// remove member, O(1), it can be called in callback.
+		bool              remove_member(uint64 id);
+
+		// has member.
+		bool              has_member(uint64 id) const { return m_index.find(id) != m_index.end(); }
+
+		// member data, nullptr if there is none.
+		attach*           get_member(uint64 id);
+
+		// member count.
+		uint32            size() const { return uint32(m_members.size()); }
+
+		// remove all members.
+		void              clear();
+
+	protected:
+		// call all members from back, so removing in callback is safe.
+		void              _fire();
+
+	protected:
+		// bound wheel.
+		CTimeWheel       &m_wheel;
+
+		// group wheel timer.
+		timer_handle      m_handle;
+
+		// member callback.
+		member_func       m_func;
+
+		// dense members.
+		std::vector<member> m_members;
+
+		// member id -> dense index.
+		CFlatMap<uint32>  m_index;
+
+		// current call round.
+		uint32            m_round;
+	};
+}
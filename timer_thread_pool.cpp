@@ -0,0 +1,57 @@
+#include "timer_thread_pool.h"
+
+namespace STimeWheelSpace {
+	CTimerThreadPool::CTimerThreadPool(uint32 threads) : m_stop(false) {
+		if (threads == 0) {
+			threads = std::thread::hardware_concurrency();
+		}
+		if (threads == 0) threads = 1;
+
+		for (uint32 i = 0; i < threads; i++) {
+			m_threads.emplace_back(&CTimerThreadPool::_work, this);
+		}
+	}
+
+	CTimerThreadPool::~CTimerThreadPool() {
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			m_stop = true;
+		}
+		m_cond.notify_all();
+		for (auto &t : m_threads) {
+			t.join();
+		}
+		m_threads.clear();
+	}
+
+	void CTimerThreadPool::dispatch(dispatch_task *tasks, uint32 count) {
+		if (count == 0) return;
+		{
+			std::lock_guard<std::mutex> guard(m_lock);
+			for (uint32 i = 0; i < count; i++) {
+				m_tasks.push_back(std::move(tasks[i]));
+			}
+		}
+		if (count == 1) {
+			m_cond.notify_one();
+		} else {
+			m_cond.notify_all();
+		}
+	}
+
+	void CTimerThreadPool::_work() {
+		for (;;) {
+			dispatch_task task;
+			{
+				std::unique_lock<std::mutex> guard(m_lock);
+				m_cond.wait(guard, [this] { return m_stop || !m_tasks.empty(); });
+				if (m_tasks.empty()) { // stop and all done.
+					return;
+				}
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+		}
+	}
+}
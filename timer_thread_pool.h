@@ -0,0 +1,47 @@
+
+// note  : built-in dispatcher of parallel dispatch mode.
+// idea  : fixed worker threads take expired callback tasks from a shared queue,
+//         a tick's batch is queued under one lock.
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+#include "time_wheel.h"
+
+namespace STimeWheelSpace {
+	class CTimerThreadPool final : public CTimerDispatcher {
+	public:
+		// thread count 0 means hardware concurrency.
+		CTimerThreadPool(uint32 threads = 0);
+		// queued tasks are all run before it returns.
+		virtual ~CTimerThreadPool();
+		// can not copyable class.
+		const CTimerThreadPool& operator=(const CTimerThreadPool& rhs) = delete;
+		CTimerThreadPool(const CTimerThreadPool& rhs) = delete;
+
+	public:
+		virtual void dispatch(dispatch_task *tasks, uint32 count) override;
+
+		uint32       get_thread_count() const { return uint32(m_threads.size()); }
+
+	protected:
+		// worker loop.
+		void         _work();
+
+	protected:
+		// worker threads.
+		std::vector<std::thread>  m_threads;
+
+		// task queue and its lock.
+		std::mutex                m_lock;
+		std::condition_variable   m_cond;
+		std::deque<dispatch_task> m_tasks;
+
+		// stop workers.
+		bool                      m_stop;
+	};
+}